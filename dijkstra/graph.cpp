@@ -1,6 +1,6 @@
 /**
  *  @file: graph.cpp
- *  @desc: Graph file is implementation of Dijkstra Algorithm which calculates 
+ *  @desc: Graph file is implementation of Dijkstra Algorithm which calculates
  *         Single Source Shortest path when user inputs a query.
  *
  *  @author: Diney Wankhede
@@ -11,15 +11,14 @@
 #include "graph.h"
 #include <string>
 #include <vector>
-#include <map>
-#include <iostream>
 #include <algorithm>
 
-using std::cout;
-using std::endl;
-using std::map;
-using std::pair;
-using std::sort;
+using std::stable_sort;
+
+const int Graph::INFINITE_KEY;
+const Graph::Id Graph::NIL;
+const int Graph::STATIC;
+const int Graph::MAX_CRITERIA;
 
 /*
  * Desc: Constructor for Graph class which intializes the currentsource.
@@ -28,143 +27,357 @@ using std::sort;
 
 Graph::Graph()
 {
-   currentSource = "NIL";
+   version = 0;
+   search = new Search();
+   turnsDirty = false;
+   profileStart.push_back(0);               //Profile 0 is the empty one
+   profileStart.push_back(0);
+   extraCosts.assign(MAX_CRITERIA - 1, 0);  //Costs 0 are all zero
+   criteria = 1;
+   labelLimit = 1 << 22;
+   queueKind = BINARY_HEAP;
 }
 
 /*
- * Desc: Desctructor for the class Graph which is responsible for deleting
- *       the entire Vertices map and AdjList map.
- *
- *       Values are deleted which frees up the memory for the entire Vertices.
- *       Similarly for the adjList map.
+ * Desc: Desctructor for the class Graph. Neighbors and names are stored by
+ *       value so they are released by their containers, only the state of
+ *       the member queries is allocated.
  *
  */
 
 Graph::~Graph()
 {
-   
-   for (std::map<string,Vertex*>::iterator it = Vertices.begin();
-       it != Vertices.end(); ++it) 
-   {
-      delete it->second;
-   }
-   
-   Vertices.clear();
-   
-   for (std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-        it != adjList.end(); ++it) 
-   {
-      for (vector<Neighbor*> :: iterator i = it->second.begin(); 
-           i != it->second.end(); i++) 
-         delete *i;
-   }
+   delete search;
+}
+
+/*
+ * Desc: Constructor for the query state, no tree is cached yet.
+ *
+ */
 
-   adjList.clear();
-   
+Graph::Search::Search()
+{
+   currentSource = NIL;
+   currentDeparture = STATIC;
+   version = 0;
 }
 
 /*
- *  Desc: Copy construtor for the private class Neighbor. 
- *        Copies dynamically to the Objects of Neighbors.
+ *  Desc: Copy construtor for the private class Neighbor.
  *
  */
 
-Graph::Neighbor::Neighbor(string new_name,int new_weight)
+Graph::Neighbor::Neighbor(Id new_name,int new_weight,uint32_t new_profile,
+                          uint32_t new_costs)
 {
    name = new_name;
    weight = new_weight;
+   profile = new_profile;
+   costs = new_costs;
 }
 
 /*
- * Default destructor for Neighbor.
- * As Neighbor members are not pointers it will be handled automatically.
+ * Desc: Copy construtor for the private class Vertex.
+ *
  */
 
-Graph::Neighbor::~Neighbor()
+Graph::Vertex::Vertex(Id new_pi,int new_key)
 {
-   
+   pi = new_pi;
+   key = new_key;
 }
 
 /*
- * Desc: Copy construtor for the private class Vertex. 
- *       Copies dynamically to the Objects of Vertex.
+ * Desc: Copy construtor for the private class Edge.
  *
  */
 
-Graph::Vertex::Vertex(string new_pi,int new_key)
+Graph::Edge::Edge(Id new_from, Id new_to, int new_weight,
+                  uint32_t new_profile, uint32_t new_costs)
+   : from(new_from), to(new_to, new_weight, new_profile, new_costs)
 {
-   pi = new_pi;
-   key = new_key;
+
+}
+
+/*
+ * Desc: Copy construtor for the private class Turn.
+ *
+ */
+
+Graph::Turn::Turn(Id new_from, Id new_via, Id new_to)
+{
+   from = new_from;
+   via = new_via;
+   to = new_to;
+}
+
+/*
+ * Desc: Copy construtor for the class Breakpoint.
+ *
+ */
+
+Graph::Breakpoint::Breakpoint(int new_time, int new_cost)
+{
+   time = new_time;
+   cost = new_cost;
+}
+
+/*
+ * Desc: Comparator which orders Neighbors alphabetically by their names.
+ *
+ */
+
+Graph::NameOrder::NameOrder(const StringPool& pool) : names(pool)
+{
+
+}
+
+bool Graph::NameOrder::operator()(const Neighbor& a, const Neighbor& b) const
+{
+   return names.view(a.name) < names.view(b.name);
 }
 
 /*
- * Default destructor for Vertex.
- * As Vertex members are not pointers it will be handled automatically.
+ * Desc: Interns a vertex name and makes sure it has a Vertex entry.
  *
+ * In:   string - name of the vertex
+ * Out:  Id - the id of the name in the pool
  */
 
-Graph::Vertex::~Vertex()
+Graph::Id Graph::vertexId(const string& name)
 {
-   
+   Id id = names.intern(name);
+   if (id >= hasIncoming.size())
+   {
+      hasIncoming.resize(id + 1, 0);
+      changed();
+   }
+   return id;
 }
 
 /*
- * Desc: This function will create the nodes for the vertex and add into the
- *       Vertices map.
+ * Desc: Number of vertices, every interned name is a vertex.
+ *
+ */
+
+size_t Graph::vertexCount() const
+{
+   return hasIncoming.size();
+}
+
+/*
+ * Desc: Records a change of the graph, trees cached by any Search built
+ *       before the change are rebuilt by their next query.
+ *
+ */
+
+void Graph::changed()
+{
+   version++;
+}
+
+/*
+ * Desc: This function will create the vertex and add it into the
+ *       Vertices table.
  *
  * In :  String - name - Name of the Vertex to be added.
- * Out:  None - Adds all the vertex to the map of Vertices.
+ * Out:  None - Adds the vertex once, duplicates are ignored.
  *
  */
 
 void Graph::addVertex(string name)
 {
-   Vertex* insert = new Vertex("NIL",101);
-   
-   if (!name.empty() && Vertices.count(name) <= 0) //Unique Vertex
-   {
-      Vertices.insert(pair<string,Vertex*>(name,insert));
-   }   
+   if (!name.empty())
+      vertexId(name);
 }
 
 /*
- * Desc: This function will create the nodes for the edges and add into the
- *       adjList map accordingly.
+ * Desc: This function will record the edge. Edges are kept pending until
+ *       the next query sorts them into the adjacency list.
  *
  * In:   string from - The starting of vertex of the a edge
  *       string to -  The ending of vertex of the a edge
  *       int weight -  The weight of the a edge
- * Out:  None - Adds all the edges to the map of adjList.
+ * Out:  None - Adds the edge to pendingEdges.
  *
  */
 
 void Graph::addEdge(string from, string to, int weight)
 {
-   Neighbor* neighborNew = new Neighbor(to,weight); //Creating a neighbor node
+   Id u = vertexId(from);
+   Id v = vertexId(to);
+   pendingEdges.push_back(Edge(u,v,weight,0,0));
+   hasIncoming[v] = 1;
+   changed();                               //Cached trees are out of date
+}
+
+/*
+ * Desc: Adds an edge whose travel time depends on the departure time.
+ *       The profile is a list of (time, cost) breakpoints sorted by time,
+ *       costs in between are interpolated and costs outside are clamped to
+ *       the first and last breakpoint.
+ *
+ * In:   string from, string to - The vertices of the edge
+ *       int weight - Static travel time used by queries without departure
+ *       vector<Breakpoint> - The travel time profile
+ * Out:  None - Adds the edge to pendingEdges.
+ *
+ */
 
-   if (adjList.empty())   
+void Graph::addEdge(string from, string to, int weight,
+                    const vector<Breakpoint>& profile)
+{
+   addEdge(from, to, vector<int>(1, weight), profile);
+}
+
+/*
+ * Desc: Adds an edge with a vector of costs. costs[0] is the weight used
+ *       by the shortest path queries, all costs are used by the Pareto
+ *       queries. Costs after MAX_CRITERIA are ignored.
+ *
+ * In:   string from, string to - The vertices of the edge
+ *       vector<int> costs - The costs of the edge
+ * Out:  None - Adds the edge to pendingEdges.
+ *
+ */
+
+void Graph::addEdge(string from, string to, const vector<int>& costs)
+{
+   addEdge(from, to, costs, vector<Breakpoint>());
+}
+
+/*
+ * Desc: Adds an edge with a vector of costs and a travel time profile.
+ *
+ */
+
+void Graph::addEdge(string from, string to, const vector<int>& costs,
+                    const vector<Breakpoint>& profile)
+{
+   if (costs.empty())
+      return;
+   int weight = costs[0];
+   uint32_t p = storeProfile(weight, profile);
+   uint32_t c = storeCosts(costs);
+
+   Id u = vertexId(from);
+   Id v = vertexId(to);
+   pendingEdges.push_back(Edge(u,v,weight,p,c));
+   hasIncoming[v] = 1;
+   changed();
+}
+
+/*
+ * Desc: Stores a travel time profile. Profiles are stored back to back in
+ *       one array, a profile with a single cost is stored as a constant
+ *       edge of that weight and a profile equal to the previous one is
+ *       shared.
+ *
+ * In:   int& weight - Static weight, replaced by a constant profile's cost
+ *       vector<Breakpoint> - The profile
+ * Out:  uint32_t - Index of the profile, 0 for a constant edge
+ *
+ */
+
+uint32_t Graph::storeProfile(int& weight, const vector<Breakpoint>& profile)
+{
+   bool constant = true;
+   for (size_t i = 1; i < profile.size(); i++)
    {
-      vector<Neighbor*> vectorNeighhbor;
-      vectorNeighhbor.push_back(neighborNew);
-      adjList.insert(pair<string,vector<Neighbor*>>(from,vectorNeighhbor));
+      if (profile[i].cost != profile[0].cost)
+         constant = false;
    }
-   else if(adjList.count(from) > 0)     //If vertex already exists
+   if (constant)
    {
-      for (std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-        it != adjList.end(); ++it) 
-      {
-         if (it->first == from)
-         {
-            adjList[it->first].push_back(neighborNew);
-         }
-      }
+      if (!profile.empty())
+         weight = profile[0].cost;
+      return 0;
    }
-   else                                 //Adding new edge
+
+   uint32_t last = (uint32_t)profileStart.size() - 2;
+   uint32_t start = profileStart[last];
+   bool same = last != 0 && profileStart[last + 1] - start == profile.size();
+   for (size_t i = 0; same && i < profile.size(); i++)
+   {
+      same = breakpoints[start + i].time == profile[i].time
+             && breakpoints[start + i].cost == profile[i].cost;
+   }
+   if (!same)
+   {
+      breakpoints.insert(breakpoints.end(), profile.begin(), profile.end());
+      profileStart.push_back((uint32_t)breakpoints.size());
+      last++;
+   }
+   return last;
+}
+
+/*
+ * Desc: Stores costs 1 .. MAX_CRITERIA-1 of an edge in extraCosts, every
+ *       edge uses MAX_CRITERIA-1 slots. Edges whose extra costs are all 0
+ *       share the zero slots at index 0.
+ *
+ * In:   vector<int> - The costs of the edge
+ * Out:  uint32_t - Index of the edge's slots in extraCosts
+ *
+ */
+
+uint32_t Graph::storeCosts(const vector<int>& costs)
+{
+   int count = std::min((int)costs.size(), (int)MAX_CRITERIA);
+   bool zero = true;
+   for (int k = 1; k < count; k++)
    {
-      vector<Neighbor*> vectorNeighhbor2;
-      vectorNeighhbor2.push_back(neighborNew);
-      adjList.insert(pair<string,vector<Neighbor*>>(from,vectorNeighhbor2));
+      if (costs[k] != 0)
+         zero = false;
    }
+   if (count > criteria)
+      criteria = count;
+   if (zero)
+      return 0;
+
+   uint32_t index = (uint32_t)(extraCosts.size() / (MAX_CRITERIA - 1));
+   for (int k = 1; k < MAX_CRITERIA; k++)
+      extraCosts.push_back(k < count ? costs[k] : 0);
+   return index;
+}
+
+/*
+ * Desc: Forbids the turn from->via->to for time-dependent queries.
+ *
+ * In:   string from, string via, string to - The three vertices of the turn
+ * Out:  None - Adds the restriction to turns.
+ *
+ */
+
+void Graph::addTurnRestriction(string from, string via, string to)
+{
+   turns.push_back(Turn(vertexId(from), vertexId(via), vertexId(to)));
+   turnsDirty = true;
+   changed();
+}
+
+/*
+ * Desc: Checks whether a vertex has at least one outgoing edge.
+ *
+ */
+
+bool Graph::hasOutgoing(Id u) const
+{
+   return u != NIL && u + 1 < firstNeighbor.size()
+          && firstNeighbor[u] != firstNeighbor[u + 1];
+}
+
+/*
+ * Desc: Sorts the adjacency list and resolves the turn restrictions. After
+ *       this the graph is not written by queries until it is changed again.
+ *
+ */
+
+void Graph::prepare()
+{
+   sortNeighbors();
+   if (turnsDirty)
+      findBannedTurns();
 }
 
 /*
@@ -173,250 +386,758 @@ void Graph::addEdge(string from, string to, int weight)
  *
  * In:   string  from- starting of the query (source)
  *       string  to- ending vertex
- * Out:  string - calls function to get the output string 
+ * Out:  string - calls function to get the output string
  *
  */
 
 string Graph::getShortestPath(string from,string to)
 {
-   sortNeighbors();       //Sort function to sort the neighbors alphabetically
-   
-   bool temp = false;     // to check if to has a path 
-   
-   for (std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-        it != adjList.end(); ++it) 
+   prepare();             //Sort function to sort the neighbors alphabetically
+   return getShortestPath(from,to,*search);
+}
+
+/*
+ * Desc: Same as above with the caller's own query state. The graph must be
+ *       prepared.
+ *
+ * In:   string  from- starting of the query (source)
+ *       string  to- ending vertex
+ *       Search  s- state written by the query
+ * Out:  string - calls function to get the output string
+ *
+ */
+
+string Graph::getShortestPath(string from,string to,Search& s) const
+{
+   Id source = names.find(from);
+   Id target = names.find(to);
+   bool temp = target != NIL && hasIncoming[target]; //to has a path
+
+   if (!hasOutgoing(source))            // if from has no outgoing edges.
    {
-      for (vector<Neighbor*> :: iterator i = it->second.begin(); 
-           i != it->second.end(); i++) 
-      {
-         if((*i)->name == to)
-            temp = true;
-      }
-   } 
+      return from + " with length 0";
+   }
+   if (!temp)
+   {
+      return from + " with lenght 0";
+   }
    //To reduce complexity calculating distance only when source is changed.
-   if (adjList.count(from) <= 0)       // if from has no outgoing edges.
+   if (source != s.currentSource || s.currentDeparture != STATIC
+       || s.version != version)
    {
-      return from + " with length 0"; 
+      buildSSPTree(source,s);
    }
-   
-   if (currentSource == "NIL")        //Initially source is NIL
+   return myGraphCompute(source,target,s);
+}
+
+/*
+ * Desc: Time-dependent query. Edge costs are evaluated at the time the
+ *       edge is entered, the reported length is the travel time. When
+ *       turn restrictions exist the search runs over edges instead of
+ *       vertices so that the incoming edge is known at every turn.
+ *
+ * In:   string from, string to - The query
+ *       int departure - Departure time at from
+ * Out:  string - The path and its travel time
+ *
+ */
+
+string Graph::getShortestPath(string from,string to,int departure)
+{
+   prepare();
+   return getShortestPath(from,to,departure,*search);
+}
+
+/*
+ * Desc: Time-dependent query with the caller's own query state.
+ *
+ */
+
+string Graph::getShortestPath(string from,string to,int departure,
+                              Search& s) const
+{
+   Id source = names.find(from);
+   Id target = names.find(to);
+   bool temp = target != NIL && hasIncoming[target];
+
+   if (!hasOutgoing(source))
    {
-      buildSSPTree(from); 
-      string answer;
-      if(temp == true)
-         answer = myGraphCompute(from,to);
-      else
-         answer = from + " with lenght 0";
-           return answer;
+      return from + " with length 0";
    }
-   else if(from == currentSource)   //If the source is same as that of current
+   if (!temp)
    {
-      string answer;
-      if(temp == true)
-         answer = myGraphCompute(from,to);
-      else
-         answer = from + " with lenght 0";
-           return answer;      
-   } 
-   else                          //New Source
+      return from + " with lenght 0";
+   }
+   bool cached = source == s.currentSource && s.currentDeparture == departure
+                 && s.version == version;
+   if (!turns.empty())
    {
-      string answer;
-      if(temp == true)
-      {
-         buildSSPTree(from); 
-         answer = myGraphCompute(from,to);
-      }
-      else
-      {
-         answer = from + " with lenght 0";
-      }
-      return answer;
+      if (!cached)
+         buildTurnTree(source, departure, s);
+      return edgePath(source, target, departure, s);
+   }
+   if (!cached)
+   {
+      buildTDTree(source, departure, s);
    }
+   return myGraphCompute(source,target,s);
 }
 
 /*
- * Desc: Calculating the path and using concatenation to generate required 
- *       output. Path is caluclated starting from to till we get from and 
+ * Desc: Calculating the path and using concatenation to generate required
+ *       output. Path is caluclated starting from to till we get from and
  *       appending to a string in  reverse order.
  *
- * In:   string from - starting of the path required
- *       string to - ending of the path 
+ * In:   Id from - starting of the path required
+ *       Id to - ending of the path
  * Ouy:  string - returns a string which is the final required output
  */
 
-string Graph::myGraphCompute(string from,string to)
+string Graph::myGraphCompute(Id from,Id to,Search& s) const
 {
-   vector<string> local;
+   if (s.Vertices[to].pi == NIL)                 //to is not reachable
+      return names.str(from) + " with lenght 0";
+
+   vector<Id> local;
    string note = " with length ";
-   string space = " ";
    string arrow = "->";
-   
-   int distance = 0;
-   string parent1 = Vertices.find(to)->second->pi;
-   
-   for(std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-       it != adjList.end(); ++it)     // Calculating the lenght
+
+   for (Id v = s.Vertices[to].pi; v != from; v = s.Vertices[v].pi)
+      local.push_back(v);
+   local.push_back(from);
+
+   string answer;
+   for (int i = (int)local.size()-1; i >= 0 ; i--) //Generating the string
+   {
+      StringView name = names.view(local[i]);
+      answer.append(name.data, name.length);
+      answer.append(arrow);
+   }
+   StringView last = names.view(to);
+   answer.append(last.data, last.length);
+   answer.append(note);
+
+   int length = s.Vertices[to].key;
+   if (s.currentDeparture != STATIC)
+      length -= s.currentDeparture;              //Travel time, not arrival
+   return answer + std::to_string(length);
+}
+
+/*
+ * Desc: Builds the path of an edge based tree by following the previous
+ *       edge of the best edge into to.
+ *
+ * In:   Id from, Id to - The query
+ *       int departure - Departure time at from
+ * Out:  string - The path and its travel time
+ */
+
+string Graph::edgePath(Id from,Id to,int departure,Search& s) const
+{
+   if (to == from || s.bestEdge[to] == NIL)
+      return names.str(from) + " with lenght 0";
+
+   vector<Id> local;
+   for (uint32_t e = s.bestEdge[to]; e != NIL; e = s.edgePi[e])
+      local.push_back(adjList[e].name);
+   local.push_back(from);
+
+   string answer;
+   for (int i = (int)local.size()-1; i >= 0 ; i--)
    {
-      if (parent1 == it->first)
+      StringView name = names.view(local[i]);
+      answer.append(name.data, name.length);
+      if (i > 0)
+         answer.append("->");
+   }
+   return answer + " with length "
+          + std::to_string(s.Vertices[to].key - departure);
+}
+
+/*
+ * Desc: Buillding the SSPTree from the current source. as per Cormen.
+ *
+ * In: Id - source - Current source which is being queried
+ * Out: Returns nothing - Updates the s.Vertices as per new source
+ *      Updates the value of key and each vertex in s.Vertices
+ *
+ */
+
+void Graph::buildSSPTree(Id source, Search& s) const
+{
+   s.currentSource = source;   //Setting the current source to New source
+   s.currentDeparture = STATIC;
+
+   initializeSingleSource(source,s); //Initializing source
+   if (queueKind == PAIRING_HEAP)
+      dijkstra(s.pairQ,s);
+   else
+      dijkstra(s.minQ,s);
+}
+
+/*
+ * Desc: Main loop of Dijkstra's algorithm on an initialized s.Vertices,
+ *       the same for the binary and the pairing heap.
+ *
+ * In: Queue - empty MinPriorityQ or PairingQ of the search
+ *
+ */
+
+template <typename Queue>
+void Graph::dijkstra(Queue& minQ, Search& s) const
+{
+   fillQueue(minQ,s);
+
+   while (!minQ.empty())
+   {
+      Id u = minQ.extractMin(); //Extracting the min from minHeap
+      if (s.Vertices[u].key == INFINITE_KEY)
+         continue;              //Rest of the queue is unreachable
+      for (uint32_t i = firstNeighbor[u]; i < firstNeighbor[u + 1]; i++)
       {
-         for (vector<Neighbor*> :: iterator i = it->second.begin(); 
-              i != it->second.end(); i++) 
-         {
-            if ((*i)->name == to) 
-            {
-               distance = distance + (*i)->weight;
-            }
-         }
+         relax(u,adjList[i].name,adjList[i].weight,s,minQ);
       }
    }
-   
-   local.push_back(parent1);    // Pushing the parent to local
-   
-   while (parent1 != from)
+}
+
+/*
+ * Desc: Time-dependent Dijkstra. Keys are arrival times, every edge is
+ *       charged its travel time at the arrival time of its tail, which is
+ *       correct as long as no edge lets a later departure arrive earlier.
+ *       Constant edges skip the profile lookup.
+ *
+ * In: Id - source - Current source which is being queried
+ *     int - departure - Departure time at the source
+ * Out: Returns nothing - Updates the s.Vertices as per new source
+ *
+ */
+
+void Graph::buildTDTree(Id source, int departure, Search& s) const
+{
+   s.currentSource = source;
+   s.currentDeparture = departure;
+
+   initializeSingleSource(source,s);
+   s.Vertices[source].key = departure;
+   for (Id v = 0; v < s.Vertices.size(); v++)
+   {
+      s.minQ.insert(v,s.Vertices[v].key);
+   }
+
+   while (!s.minQ.empty())
    {
-      string parentOld = parent1;
-      parent1 = Vertices.find(parent1)->second->pi;
-      local.push_back(parent1);
- 
-      for(std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-          it != adjList.end(); ++it)
+      Id u = s.minQ.extractMin();
+      int arrival = s.Vertices[u].key;
+      if (arrival == INFINITE_KEY)
+         continue;
+      for (uint32_t i = firstNeighbor[u]; i < firstNeighbor[u + 1]; i++)
       {
-         if (parent1 == it->first)
+         int w = adjList[i].profile == 0 ? adjList[i].weight
+                                         : travelTime(adjList[i], arrival);
+         if ((int64_t)arrival + w <= INFINITE_KEY)
+            relax(u,adjList[i].name,w,s,s.minQ);
+      }
+   }
+}
+
+/*
+ * Desc: Time-dependent Dijkstra over edges. A queue entry is an edge of
+ *       adjList keyed by the arrival time at its head, so a restricted
+ *       turn is simply an out edge which is not relaxed from that entry.
+ *       Entering a vertex over an edge without restrictions allows every
+ *       turn, so only the first such edge is s.expanded, later ones cannot
+ *       lead anywhere faster.
+ *
+ * In: Id - source - Current source which is being queried
+ *     int - departure - Departure time at the source
+ * Out: Returns nothing - Updates s.edgeKey, s.edgePi, s.bestEdge and s.Vertices
+ *
+ */
+
+void Graph::buildTurnTree(Id source, int departure, Search& s) const
+{
+   s.currentSource = source;
+   s.currentDeparture = departure;
+
+   initializeSingleSource(source,s);
+   s.Vertices[source].key = departure;
+   s.edgeKey.assign(adjList.size(), INFINITE_KEY);
+   s.edgePi.assign(adjList.size(), NIL);
+   s.bestEdge.assign(s.Vertices.size(), NIL);
+   s.expanded.assign(s.Vertices.size(), 0);
+   s.expanded[source] = 1;
+
+   for (uint32_t f = firstNeighbor[source]; f < firstNeighbor[source + 1];
+        f++)
+      relaxEdge(NIL, f, departure, s);
+
+   while (!s.minQ.empty())
+   {
+      uint32_t e = s.minQ.extractMin();
+      Id v = adjList[e].name;
+      int arrival = s.edgeKey[e];
+      if (arrival < s.Vertices[v].key)
+      {
+         s.Vertices[v].key = arrival;
+         s.bestEdge[v] = e;
+      }
+      if (!restrictedIn[e])
+      {
+         if (s.expanded[v])
+            continue;           //v was left without restriction already
+         s.expanded[v] = 1;
+      }
+      for (uint32_t f = firstNeighbor[v]; f < firstNeighbor[v + 1]; f++)
+      {
+         if (restrictedIn[e] && std::binary_search(bannedTurns.begin(),
+                                  bannedTurns.end(), ((uint64_t)e << 32) | f))
+            continue;                           //Restricted turn
+         relaxEdge(e, f, arrival, s);
+      }
+   }
+}
+
+/*
+ * Desc: Relaxes edge f entered at time arrival coming from edge e.
+ *
+ */
+
+void Graph::relaxEdge(uint32_t e, uint32_t f, int arrival,
+                      Search& s) const
+{
+   int w = adjList[f].profile == 0 ? adjList[f].weight
+                                   : travelTime(adjList[f], arrival);
+   if ((int64_t)arrival + w > INFINITE_KEY || s.edgeKey[f] <= arrival + w)
+      return;
+   if (s.edgeKey[f] == INFINITE_KEY)
+      s.minQ.insert(f, arrival + w);
+   else
+      s.minQ.decreaseKey(f, arrival + w);
+   s.edgeKey[f] = arrival + w;
+   s.edgePi[f] = e;
+}
+
+/*
+ * Desc: Travel time of an edge entered at time t, interpolated between the
+ *       breakpoints of its profile.
+ *
+ * In: Neighbor - the edge
+ *     int t - time the edge is entered
+ * Out: int - travel time
+ *
+ */
+
+int Graph::travelTime(const Neighbor& edge, int t) const
+{
+   if (edge.profile == 0)
+      return edge.weight;
+   const Breakpoint* first = &breakpoints[profileStart[edge.profile]];
+   const Breakpoint* last = &breakpoints[profileStart[edge.profile + 1] - 1];
+   if (t <= first->time)
+      return first->cost;
+   if (t >= last->time)
+      return last->cost;
+
+   const Breakpoint* hi = first + 1;
+   while (hi->time <= t)
+      hi++;
+   const Breakpoint* lo = hi - 1;
+   return lo->cost + (int)((long long)(hi->cost - lo->cost) * (t - lo->time)
+                           / (hi->time - lo->time));
+}
+
+/*
+ * Desc: Translates the turn restrictions into sorted (in edge, out edge)
+ *       index pairs of adjList. Needs to run again whenever adjList is
+ *       rebuilt or a restriction is added.
+ *
+ */
+
+void Graph::findBannedTurns()
+{
+   bannedTurns.clear();
+   restrictedIn.assign(adjList.size(), 0);
+   for (size_t t = 0; t < turns.size(); t++)
+   {
+      const Turn& turn = turns[t];
+      for (uint32_t e = firstNeighbor[turn.from];
+           e < firstNeighbor[turn.from + 1]; e++)
+      {
+         if (adjList[e].name != turn.via)
+            continue;
+         for (uint32_t f = firstNeighbor[turn.via];
+              f < firstNeighbor[turn.via + 1]; f++)
          {
-            for (vector<Neighbor*> :: iterator i = it->second.begin(); 
-                 i != it->second.end(); i++) 
+            if (adjList[f].name == turn.to)
             {
-               if ((*i)->name == parentOld) 
-               {
-                  distance = distance + (*i)->weight;
-               }
+               bannedTurns.push_back(((uint64_t)e << 32) | f);
+               restrictedIn[e] = 1;
             }
          }
       }
    }
-   string distanceS = std::to_string(distance);    //Int to String
+   std::sort(bannedTurns.begin(), bannedTurns.end());
+   turnsDirty = false;
+}
+
+/*
+ * Desc: Multi-criteria query. Every path from the Pareto set between from
+ *       and to is printed on its own line with its cost vector, ordered by
+ *       the first cost.
+ *
+ * In:   string from, string to - The query
+ * Out:  string - One line per Pareto optimal path
+ *
+ */
+
+string Graph::getParetoPaths(string from,string to)
+{
+   prepare();
+   return getParetoPaths(from,to,*search);
+}
+
+/*
+ * Desc: Multi-criteria query with the caller's own query state.
+ *
+ */
+
+string Graph::getParetoPaths(string from,string to,Search& s) const
+{
+
+   Id source = names.find(from);
+   Id target = names.find(to);
+   if (!hasOutgoing(source))
+   {
+      return from + " with length 0";
+   }
+   if (target == NIL || !hasIncoming[target] || target == source)
+   {
+      return from + " with lenght 0";
+   }
+
+   bool complete = buildParetoSet(source, target, s);
+   vector<uint32_t> found;
+   for (uint32_t l = s.labelHead[target]; l != NIL; l = s.labels[l].next)
+      found.push_back(l);
+   if (found.empty())
+      return from + " with lenght 0";
+   for (size_t i = 1; i < found.size(); i++)     //Insertion sort by costs
+   {
+      uint32_t key = found[i];
+      int j = (int)i - 1;
+      while (j >= 0 && std::lexicographical_compare(s.labels[key].cost,
+                s.labels[key].cost + criteria, s.labels[found[j]].cost,
+                s.labels[found[j]].cost + criteria))
+      {
+         found[j + 1] = found[j];
+         j--;
+      }
+      found[j + 1] = key;
+   }
+
    string answer;
-   
-   for (int i = (int)local.size()-1; i >= 0 ; i--) //Generating the string 
+   for (size_t i = 0; i < found.size(); i++)
    {
-      answer.append(local[i]);
-      answer.append(arrow);
+      vector<Id> local;
+      for (uint32_t l = found[i]; l != NIL; l = s.labels[l].pred)
+         local.push_back(s.labels[l].vertex);
+      if (i > 0)
+         answer.append("\n");
+      for (int j = (int)local.size() - 1; j >= 0; j--)
+      {
+         StringView name = names.view(local[j]);
+         answer.append(name.data, name.length);
+         if (j > 0)
+            answer.append("->");
+      }
+      answer.append(" with costs ");
+      for (int k = 0; k < criteria; k++)
+      {
+         if (k > 0)
+            answer.append(",");
+         answer.append(std::to_string(s.labels[found[i]].cost[k]));
+      }
    }
-   answer.append(to);
-   answer.append(note);
-   
-   return answer + distanceS; //Concatenating length to path of string 
+   if (!complete)
+      answer.append("\nlabel limit reached, set may be incomplete");
+   return answer;
 }
 
 /*
- * Desc: Buillding the SSPTree from the current source. as per Cormen.
+ * Desc: Bounds the number of s.labels a Pareto query may create.
+ *
+ */
+
+void Graph::setLabelLimit(size_t limit)
+{
+   labelLimit = limit;
+}
+
+/*
+ * Desc: Queues every vertex with its initial key, as in Cormen.
+ *
+ */
+
+void Graph::fillQueue(MinPriorityQ& minQ, Search& s) const
+{
+   for (Id v = 0; v < s.Vertices.size(); v++)
+   {
+      minQ.insert(v,s.Vertices[v].key);  //Inserting in minHeap
+   }
+}
+
+/*
+ * Desc: Queues only the source, relax() inserts a vertex into the pairing
+ *       heap when it is first reached. Unreachable vertices never enter
+ *       it, which keeps its root list short.
+ *
+ */
+
+void Graph::fillQueue(PairingQ& minQ, Search& s) const
+{
+   minQ.reset(s.Vertices.size());
+   minQ.insert(s.currentSource,0);
+}
+
+/*
+ * Desc: Picks the priority queue of the static queries. The binary heap is
+ *       the default, sspbench runs both so the faster one for a kind of
+ *       graph can be chosen.
+ *
+ */
+
+void Graph::setQueue(QueueKind kind)
+{
+   queueKind = kind;
+}
+
+/*
+ * Desc: Checks whether a settled label at v is at least as good as cost in
+ *       every criterion.
  *
- * In: string - source - Current source which is being queried
- * Out: Returns nothing - Updates the Vertices of the map as per new source
- *      Updates the value of key and each vertex in map of Vertices
+ * In:   Id v - Vertex whose settled s.labels are checked
+ *       const int* cost - Cost vector of the candidate
+ * Out:  bool - true when the candidate is dominated
  *
  */
 
-void Graph::buildSSPTree(string source)
+bool Graph::dominated(Id v, const int* cost, Search& s) const
 {
-   currentSource = source;   //Setting the current source to New source
-   
-   initializeSingleSource(source); //Initializing source
-   for (std::map<string,Vertex*>::iterator it = Vertices.begin();
-        it != Vertices.end(); ++it) 
+   if (criteria <= 2)                            //Staircase, see below
+   {
+      uint32_t l = s.labelHead[v];
+      return l != NIL && s.labels[l].cost[0] <= cost[0]
+             && s.labels[l].cost[1] <= cost[1];
+   }
+   for (uint32_t l = s.labelHead[v]; l != NIL; l = s.labels[l].next)
    {
-      minQ.insert(it->first,it->second->key);  //Inserting in minHeap
+      const int* other = s.labels[l].cost;
+      int k = 0;
+      while (k < criteria && other[k] <= cost[k])
+         k++;
+      if (k == criteria)
+         return true;
    }
-   int size = Vertices.size();
-   
-   while (size != 0)
+   return false;
+}
+
+/*
+ * Desc: Label-setting multi-criteria Dijkstra. Labels live in one arena
+ *       and are extracted in order of the sum of their costs, so a label
+ *       can only be dominated by s.labels settled before it. Labels which
+ *       are dominated at their vertex or at the target are dropped as soon
+ *       as they are created and again when they are extracted.
+ *
+ *       With two criteria s.labels are extracted by their first cost. The
+ *       settled s.labels of a vertex then form a staircase whose last label
+ *       has the lowest second cost, so dominance is a single comparison
+ *       with the head of the list. A label settled with the same first
+ *       cost as the head replaces it.
+ *
+ * In:   Id source, Id target - The query
+ * Out:  bool - false when the label limit stopped the search early
+ *
+ */
+
+bool Graph::buildParetoSet(Id source, Id target, Search& s) const
+{
+   bool complete = true;
+   s.labels.clear();
+   s.labelHead.assign(vertexCount(), NIL);
+
+   Label first;
+   std::fill(first.cost, first.cost + MAX_CRITERIA, 0);
+   first.vertex = source;
+   first.pred = NIL;
+   first.next = NIL;
+   s.labels.push_back(first);
+   s.minQ.insert(0, 0);
+
+   while (!s.minQ.empty())
    {
-      string u = minQ.extractMin(); //Extracting the min from minHeap
-      for (std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-          it != adjList.end(); ++it) 
+      uint32_t l = s.minQ.extractMin();
+      Label current = s.labels[l];
+      Id u = current.vertex;
+      if (dominated(u, current.cost, s) || dominated(target, current.cost, s))
+         continue;
+      uint32_t head = s.labelHead[u];
+      if (criteria <= 2 && head != NIL
+          && s.labels[head].cost[0] == current.cost[0])
+         head = s.labels[head].next;               //Dominated by current
+      s.labels[l].next = head;                     //Settle the label
+      s.labelHead[u] = l;
+      if (u == target)
+         continue;
+
+      for (uint32_t i = firstNeighbor[u]; i < firstNeighbor[u + 1]; i++)
       {
-         if (it->first == u) 
+         Label next;
+         const int* extra = &extraCosts[adjList[i].costs * (MAX_CRITERIA - 1)];
+         next.cost[0] = current.cost[0] + adjList[i].weight;
+         int sum = next.cost[0];
+         for (int k = 1; k < MAX_CRITERIA; k++)
          {
-            for (vector<Neighbor*>::iterator i = it->second.begin(); 
-                 i != it->second.end(); i++) 
-            {
-               relax(u,(*i)->name,(*i)->weight);  
-            }
+            next.cost[k] = current.cost[k] + extra[k - 1];
+            sum += next.cost[k];
+         }
+         next.vertex = adjList[i].name;
+         if (dominated(next.vertex, next.cost, s)
+             || dominated(target, next.cost, s))
+            continue;
+         if (s.labels.size() >= labelLimit)
+         {
+            complete = false;
+            continue;
          }
+         next.pred = l;
+         next.next = NIL;
+         s.labels.push_back(next);
+         s.minQ.insert((uint32_t)s.labels.size() - 1,
+                     criteria <= 2 ? next.cost[0] : sum);
       }
-      size --;
    }
+   return complete;
 }
 
 /*
  * Desc: Relaxing the weights as per requirement. As per Cormen Implementation
  *
- * In: string u - Start of the edge
- *     string v - End of edge
+ * In: Id u - Start of the edge
+ *     Id v - End of edge
  *     int w - Weight of particular edge u->v
- * Out: Modifies the map of Vertices and updates the weights.
+ * Out: Modifies s.Vertices and updates the weights.
  *
  */
 
-void Graph::relax(string u, string v , int w)
-{   
-   if (Vertices.find(v)->second->key > (Vertices.find(u)->second->key + w)) 
+template <typename Queue>
+void Graph::relax(Id u, Id v , int w, Search& s, Queue& minQ) const
+{
+   if (s.Vertices[v].key > (s.Vertices[u].key + w))
    {
-      Vertices.find(v)->second->key = (Vertices.find(u)->second->key + w);
-      Vertices.find(v)->second->pi = u;
+      s.Vertices[v].key = (s.Vertices[u].key + w);
+      s.Vertices[v].pi = u;
       //Updating the value in the minHeap Q
-      minQ.decreaseKey(v,(Vertices.find(u)->second->key + w));
+      minQ.decreaseKey(v,s.Vertices[v].key);
    }
 }
 
 /*
  * Desc: Intializes the vertices before building the SSP Tree. As per Cormen
  *
- * In: string s - The source which  is the current source
+ * In: Id source - The source which  is the current source
+ *     Search s - The state of the query
  *
- * Out: None - Vertices will be intialized
+ * Out: None - s.Vertices will be intialized
  *
  */
 
-void Graph::initializeSingleSource(string s)
+void Graph::initializeSingleSource(Id source, Search& s) const
 {
-   for (std::map<string,Vertex*>::iterator it = Vertices.begin();
-       it != Vertices.end(); ++it) 
-   {
-      it->second->key = 101;
-      it->second->pi = "NIL";
-   }
-   Vertices.find(s)->second->key = 0;
+   s.version = version;
+   s.Vertices.assign(vertexCount(), Vertex(NIL,INFINITE_KEY));
+   s.Vertices[source].key = 0;
 }
 
 /*
- * Desc: Function to sort the vector of Neighbors in the adjList list.
- * 
- * In: None - uses map of adjList 
+ * Desc: Merges the pending edges into the adjacency list. Neighbors of a
+ *       vertex are stored contiguously starting at firstNeighbor[vertex]
+ *       and are sorted alphabetically, equal names keep insertion order.
+ *       Does nothing when no edge was added since the last call.
+ *
+ * In: None - uses pendingEdges and adjList
  *
- * Out: None - Sorts the adjList using insertion sort
+ * Out: None - Rebuilds firstNeighbor and adjList
  *
  */
 
 void Graph::sortNeighbors()
 {
-   int i;
-   Neighbor* key;
+   if (pendingEdges.empty() && firstNeighbor.size() == vertexCount() + 1)
+      return;
+
+   size_t n = vertexCount();
+   vector<uint32_t> first(n + 1, 0);
+   for (Id u = 0; u + 1 < firstNeighbor.size(); u++)
+      first[u + 1] += firstNeighbor[u + 1] - firstNeighbor[u];
+   for (size_t i = 0; i < pendingEdges.size(); i++)
+      first[pendingEdges[i].from + 1]++;
+   for (size_t u = 0; u < n; u++)
+      first[u + 1] += first[u];
 
-   for (std::map<string,vector<Neighbor*>>::iterator it = adjList.begin();
-        it != adjList.end(); ++it) 
+   vector<Neighbor> sorted(first[n], Neighbor(NIL,0,0,0));
+   vector<uint32_t> next(first.begin(), first.end() - 1);
+   for (Id u = 0; u + 1 < firstNeighbor.size(); u++)
    {
- 
-      for(int j = 1; j < (int) it->second.size(); j++)
-      {
-         key = it->second[j]; 
-         i = j - 1;
-         while(i >= 0  && (it->second[i]->name) > (key->name))
-         {
-            it->second[i+1] = it->second[i];
-            i = i - 1;
-         }
-         (it->second[i+1]) = key;
-      }
+      for (uint32_t i = firstNeighbor[u]; i < firstNeighbor[u + 1]; i++)
+         sorted[next[u]++] = adjList[i];
    }
+   for (size_t i = 0; i < pendingEdges.size(); i++)
+      sorted[next[pendingEdges[i].from]++] = pendingEdges[i].to;
+
+   NameOrder order(names);
+   for (size_t u = 0; u < n; u++)
+      stable_sort(sorted.begin() + first[u], sorted.begin() + first[u + 1],
+                  order);
+
+   adjList.swap(sorted);
+   firstNeighbor.swap(first);
+   vector<Edge>().swap(pendingEdges);
+   turnsDirty = true;                         //Edge indices have changed
+   changed();
+}
+
+/*
+ * Desc: Approximate number of bytes held by the graph and its names.
+ *
+ */
+
+size_t Graph::memoryUsage() const
+{
+   return names.bytes()
+          + firstNeighbor.capacity() * sizeof(uint32_t)
+          + adjList.capacity() * sizeof(Neighbor)
+          + hasIncoming.capacity()
+          + pendingEdges.capacity() * sizeof(Edge)
+          + profileStart.capacity() * sizeof(uint32_t)
+          + breakpoints.capacity() * sizeof(Breakpoint)
+          + turns.capacity() * sizeof(Turn)
+          + bannedTurns.capacity() * sizeof(uint64_t)
+          + restrictedIn.capacity()
+          + extraCosts.capacity() * sizeof(int)
+          + search->memoryUsage();
+}
+
+/*
+ * Desc: Approximate number of bytes held by the state of a query.
+ *
+ */
+
+size_t Graph::Search::memoryUsage() const
+{
+   return Vertices.capacity() * sizeof(Vertex)
+          + expanded.capacity()
+          + edgeKey.capacity() * sizeof(int)
+          + (edgePi.capacity() + bestEdge.capacity()) * sizeof(uint32_t)
+          + labels.capacity() * sizeof(Label)
+          + labelHead.capacity() * sizeof(uint32_t);
 }
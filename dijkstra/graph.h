@@ -1,9 +1,26 @@
 /*
  *  @file: graph.h
  *  @desc: Implmentation of Core Single Source Shortest Path Algorithm
- *         of Dijkstra's Algorithm                  
+ *         of Dijkstra's Algorithm
  *
- *  @author: Diney Wankhede 
+ *         Vertex names are interned once in a StringPool, the vertices,
+ *         the adjacency list and the priority queue only hold the 4-byte
+ *         ids handed out by the pool.
+ *
+ *         Edges may carry a travel time profile, a piecewise-linear
+ *         function of the departure time. Queries given a departure time
+ *         run a time-dependent Dijkstra over arrival times and honour the
+ *         turn restrictions, queries without one use the static weights.
+ *
+ *         Edges may also carry up to MAX_CRITERIA costs (e.g. distance and
+ *         toll). getParetoPaths() runs a label-setting search and returns
+ *         every path whose cost vector is not dominated by another one.
+ *
+ *         Queries only write to a Graph::Search. The graph itself is read
+ *         only after prepare(), so several threads can answer queries on
+ *         one graph, each with its own Search.
+ *
+ *  @author: Diney Wankhede
  *  @date:  4/26/15.
  */
 
@@ -13,48 +30,184 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <climits>
+#include <stdint.h>
 #include "minpriority.h"
+#include "pairingq.h"
+#include "stringpool.h"
 
 using std::string;
 using std::vector;
-using std::map;
 
 class Graph
 {
 public:
+   class Breakpoint                                  //Point of a profile
+   {
+   public:
+      Breakpoint(int,int);                           //Copy Constructor
+      int time;                                      //Departure time
+      int cost;                                      //Travel time then
+   };
+   class Search;                                     //State of one query
+   enum QueueKind                                    //Queue of buildSSPTree
+   {
+      BINARY_HEAP,                                   //O(log n) decreaseKey
+      PAIRING_HEAP                                   //O(1) amortized one
+   };
+
    Graph();                                          //Constructor
    ~Graph();                                         //Destructor
    void addVertex(string name);                      //Add Vertex to Vertices
    void addEdge(string from, string to, int weight); //Add edges to adjList
+   void addEdge(string from, string to, int weight,  //Edge with a profile
+                const vector<Breakpoint>& profile);
+   void addEdge(string from, string to,              //Edge with several costs
+                const vector<int>& costs);
+   void addEdge(string from, string to, const vector<int>& costs,
+                const vector<Breakpoint>& profile);
+   void addTurnRestriction(string from, string via, string to);
    string getShortestPath(string from,string to);    //Getting shortest path
-   
+   string getShortestPath(string from,string to,int departure);
+   string getParetoPaths(string from,string to);     //Pareto set of paths
+   void setLabelLimit(size_t);                       //Bound on label arena
+   void setQueue(QueueKind);                         //Queue of static queries
+   void sortNeighbors();                             //Sorting Neighbors
+   void prepare();                                   //Ready for const queries
+   size_t memoryUsage() const;                       //Bytes held by graph
+
+   //Read-only queries, safe from several threads once prepare() was called
+   //as long as every thread passes its own Search
+   string getShortestPath(string,string,Search&) const;
+   string getShortestPath(string,string,int,Search&) const;
+   string getParetoPaths(string,string,Search&) const;
+
+   static const int INFINITE_KEY = INT_MAX;          //Key of unreached vertex
+   static const int MAX_CRITERIA = 4;                //Costs per edge at most
+
 private:
+   typedef StringPool::Id Id;
+   static const Id NIL = StringPool::NONE;
+   static const int STATIC = INT_MIN;            //Departure of static tree
+
    class Vertex
    {
    public:
-      Vertex(string,int);                        //Copy Constructor
-      ~Vertex();                                 //Destructor
-      string pi;
+      Vertex(Id,int);                            //Copy Constructor
+      Id pi;
       int key;
    };
-   class Neighbor 
+   class Neighbor
    {
    public:
-      Neighbor(string,int);                      //Copy Constructor
-      ~Neighbor();                               //Destructor 
-      string name;
-      int weight;
+      Neighbor(Id,int,uint32_t,uint32_t);        //Copy Constructor
+      Id name;
+      int weight;                                //Static travel time
+      uint32_t profile;                          //0 when cost is constant
+      uint32_t costs;                            //0 when no extra costs
    };
+   class Edge                                    //Edge waiting to be sorted
+   {
+   public:
+      Edge(Id,Id,int,uint32_t,uint32_t);         //Copy Constructor
+      Id from;
+      Neighbor to;
+   };
+   class Turn                                    //Restricted from->via->to
+   {
+   public:
+      Turn(Id,Id,Id);                            //Copy Constructor
+      Id from;
+      Id via;
+      Id to;
+   };
+   class Label                                   //Path in Pareto search
+   {
+   public:
+      int cost[MAX_CRITERIA];                    //Cost vector of the path
+      Id vertex;                                 //Last vertex of the path
+      uint32_t pred;                             //Label of path prefix
+      uint32_t next;                             //Next settled at vertex
+   };
+   class NameOrder                               //Orders Neighbors by name
+   {
+   public:
+      NameOrder(const StringPool&);
+      bool operator()(const Neighbor&, const Neighbor&) const;
+      const StringPool& names;
+   };
+
+   StringPool names;                             //Every vertex name once
+   uint32_t version;                             //Bumped on every change
+   vector<uint32_t> firstNeighbor;               //Start of adjList by id
+   vector<Neighbor> adjList;                     //Sorted adjacency list
+   vector<char> hasIncoming;                     //Vertex is an edge target
+   vector<Edge> pendingEdges;                    //Added since last sort
+   vector<uint32_t> profileStart;                //Breakpoints by profile
+   vector<Breakpoint> breakpoints;               //All profiles back to back
+   vector<Turn> turns;                           //Restrictions by name
+   vector<uint64_t> bannedTurns;                 //(in edge, out edge) pairs
+   bool turnsDirty;                              //bannedTurns out of date
+   vector<char> restrictedIn;                    //Edge starts a banned turn
+   vector<int> extraCosts;                       //Costs 1.. by Neighbor
+   int criteria;                                 //Costs used by any edge
+   size_t labelLimit;                            //Arena size bound
+   QueueKind queueKind;                          //Queue of buildSSPTree
+   Search* search;                               //State of member queries
+
+   void buildSSPTree(Id source, Search&) const;  //Dijkstra function
+   template <typename Queue>                     //Dijkstra on either queue
+   void dijkstra(Queue&, Search&) const;
+   void fillQueue(MinPriorityQ&, Search&) const; //Every vertex up front
+   void fillQueue(PairingQ&, Search&) const;     //Source only, lazy
+   void buildTDTree(Id, int, Search&) const;     //Time-dependent Dijkstra
+   void buildTurnTree(Id, int, Search&) const;   //Edge based, with turns
+   int travelTime(const Neighbor&, int) const;   //Cost of edge at a time
+   void relaxEdge(uint32_t e, uint32_t f, int arrival, Search&) const;
+   void findBannedTurns();                       //Turns to edge pairs
+   string edgePath(Id,Id,int,Search&) const;     //Print edge based path
+   uint32_t storeProfile(int&, const vector<Breakpoint>&); //Profile index
+   uint32_t storeCosts(const vector<int>&);      //extraCosts index
+   bool buildParetoSet(Id, Id, Search&) const;   //Label-setting search
+   bool dominated(Id v, const int* cost, Search&) const; //Label dominates
+   template <typename Queue>                             //Helper function
+   void relax(Id u, Id v, int weight, Search&, Queue&) const;
+   void initializeSingleSource(Id, Search&) const;       //Helper
+   string myGraphCompute(Id,Id,Search&) const;   //Print the path
+   Id vertexId(const string&);                   //Interns a vertex name
+   bool hasOutgoing(Id) const;                   //Vertex has an edge out
+   size_t vertexCount() const;                   //Number of vertices
+   void changed();                               //Invalidates trees
+
+   Graph(const Graph&);                          //Not copyable
+   Graph& operator=(const Graph&);
+};
+
+/*
+ * Desc: Everything a query writes. Trees are cached per Search, so a thread
+ *       asking several queries from the same source builds the tree once.
+ */
+
+class Graph::Search
+{
+public:
+   Search();                                     //Constructor
+   size_t memoryUsage() const;                   //Bytes held by the state
+
+private:
+   friend class Graph;
    MinPriorityQ minQ;                            //Object of inner class
-   string currentSource;                         //currentSource init to "NIL"
-   map<string,Vertex*> Vertices;                 //Stroring all vertices
-   map<string,vector<Neighbor*>> adjList;        //Adjacency List
-   void buildSSPTree(string source);             //Dijkstra function
-   void relax(string u, string v, int weight);   //Helper function
-   void initializeSingleSource(string);          //Helper
-   string myGraphCompute(string,string);         //Print the path     
-   void sortNeighbors();                         //Sorting Neighbors
-};  
+   PairingQ pairQ;                               //Queue of PAIRING_HEAP
+   Id currentSource;                             //currentSource init to NIL
+   int currentDeparture;                         //STATIC for static tree
+   uint32_t version;                             //Graph version of tree
+   vector<Vertex> Vertices;                      //Vertex by name id
+   vector<int> edgeKey;                          //Arrival by edge, turns on
+   vector<uint32_t> edgePi;                      //Previous edge, turns on
+   vector<uint32_t> bestEdge;                    //Best edge into vertex
+   vector<char> expanded;                        //Left by unrestricted edge
+   vector<Label> labels;                         //Label arena of a query
+   vector<uint32_t> labelHead;                   //Settled labels by vertex
+};
 
 #endif /* defined(____graph__) */
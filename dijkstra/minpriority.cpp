@@ -1,7 +1,7 @@
 /**
  *  @file: minpriority.cpp
- *  @desc: This file has implementation of all the functions required to 
- *         maintain minpriority queue using minheap. Most of the functions 
+ *  @desc: This file has implementation of all the functions required to
+ *         maintain minpriority queue using minheap. Most of the functions
  *         written as per the implementation of Cormen.
  *
  *  @author: Diney Wankhede
@@ -11,19 +11,11 @@
  */
 
 #include "minpriority.h"
-#include <string>
 #include <vector>
-#include <iostream>
-#include <sstream>
-#include <math.h>
-
-using std::string;
-using std::cout;
-using std::cin;
-using std::stringstream;
-using std::endl;
+
 using std::swap;
-using std::to_string;
+
+const uint32_t MinPriorityQ::EMPTY;
 
 /**
  * Constructor for class MinPriorityQ.
@@ -39,18 +31,13 @@ MinPriorityQ::MinPriorityQ ()
 /**
  *
  * Destructor for class MinPriorityQ.
+ * Elements are stored by value so nothing has to be freed here.
  *
  */
 
 MinPriorityQ::~MinPriorityQ()
 {
-   for(vector<Element*>::iterator it = minHeap.begin();
-       it != minHeap.end();it++)
-   {
-      delete *(it);
-      minHeap.erase(it);
-   }
-   minHeap.clear();
+
 }
 
 /**
@@ -60,94 +47,76 @@ MinPriorityQ::~MinPriorityQ()
  *
  */
 
-MinPriorityQ::Element::Element(string new_id,int new_key)
+MinPriorityQ::Element::Element(uint32_t new_id,int new_key)
 {
   id = new_id ;
   key = new_key;
 }
 
-/**
- * Destructor for Element class.
- *
- */
-
-
-MinPriorityQ::Element::~Element()
-{
-
-}
-
 /**
  * Desc: Function to insert an element into the queue. Similar to algorithm
  *       in Cormen.
  *
- * In:   String - Id - User input of string
+ * In:   uint32_t - Id - Handle of the element
  *       Integer - Key - Key of type integer to min pq
  *
- * Out:  None - Creates new Element and pushes in the vector. Creates minHeap.
+ * Out:  None - Appends the Element and sifts it up into place.
  */
 
-void MinPriorityQ::insert(string id, int key)
+void MinPriorityQ::insert(uint32_t id, int key)
 {
-   Element* insert = new Element(id,key);
-   minHeap.push_back(insert);
+   if (id >= position.size())
+      position.resize(id + 1, -1);
+   minHeap.push_back(Element(id,key));
+   position[id] = (int)minHeap.size() - 1;
    decreaseKey(id,key);
 }
 
 /**
  * Desc: Function to decrease the key as and when an update is required.
  *
- * In:   String - Id - User input of string
+ * In:   uint32_t - Id - Handle of the element
  *       Integer - Key - Key of type integer to min pq
  *
  *
  *
  */
 
-void MinPriorityQ::decreaseKey(string id,int key)
+void MinPriorityQ::decreaseKey(uint32_t id,int key)
 {
-   int i = 0;
-   int j = 0;
-   for(vector <Element*>::iterator it = minHeap.begin(); it != minHeap.end();
-         it++)
-   {
-      if((*it)->id == id)
-      {
-         i = j;
-      }
-      j++;
-   }
+   if (!isMember(id))
+      return;
+   int i = position[id];
 
-   if(key > minHeap[i]->key)
+   if(key > minHeap[i].key)
       return;
-   minHeap[i]->key = key;
-   
-   while(i > 0 && (minHeap[parent(i)]->key) > minHeap[i]->key)
+   minHeap[i].key = key;
+
+   while(i > 0 && (minHeap[parent(i)].key) > minHeap[i].key)
    {
-      swap(minHeap[i] , minHeap[parent(i)]);
+      exchange(i, parent(i));
       i = parent(i);
    }
 }
 
 /**
- * Desc: This Function extracts and returns a string which is the minimum
+ * Desc: This Function extracts and returns the id which is the minimum
  *       and removes that particular element from the queue.
  *
  * In:   None - Using the member minHeap.
- * Out:  string - Returns the minimum string id which is later printed.
+ * Out:  uint32_t - Returns the minimum id, EMPTY if queue is empty.
  */
 
-string MinPriorityQ::extractMin()
+uint32_t MinPriorityQ::extractMin()
 {
    if(minHeap.size() < 1)       //If size 0, return empty.
    {
-      string null = "empty";
-      return null;
+      return EMPTY;
    }
-   string min = minHeap[0]->id; //The minimum will be at 1st position always
-   minHeap[0] = NULL;
-   minHeap[0] = minHeap[minHeap.size()-1];
+   uint32_t min = minHeap[0].id; //The minimum will be at 1st position always
+   exchange(0, (int)minHeap.size() - 1);
    minHeap.pop_back();          //Deletes last element
+   position[min] = -1;
    if((int)minHeap.size() > 1)
       minHeapify(0);             //Maintaining heap property after extract.
    return min;
@@ -156,20 +125,24 @@ string MinPriorityQ::extractMin()
 /**
  * Desc: This function checks if the input id is present in the queue or not.
  *
- * In:   String - id - The id which is to be searched.
- * Out:  boolean - true if there exists input string in the queue else false.
+ * In:   uint32_t - id - The id which is to be searched.
+ * Out:  boolean - true if there exists input id in the queue else false.
  *
  */
 
-bool MinPriorityQ::isMember(string id)
+bool MinPriorityQ::isMember(uint32_t id)
 {
-   for(vector<Element*>::iterator it = minHeap.begin();
-         it != minHeap.end();it++)
-   {
-      if((*it) -> id == id)
-         return true;
-   }
-   return false;
+   return id < position.size() && position[id] >= 0;
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+bool MinPriorityQ::empty()
+{
+   return minHeap.empty();
 }
 
 /**
@@ -177,56 +150,65 @@ bool MinPriorityQ::isMember(string id)
  *       property on the in input integer.
  *
  * In:   Integer - position of Element which is to be checked.
- * Out:  Returns nothing - MinHeap proprty is maintained on input. 
+ * Out:  Returns nothing - MinHeap proprty is maintained on input.
  *
  */
 
 void MinPriorityQ::minHeapify(int i)
 {
-   int l = left(i);
-   int r = right(i);
-   int smallest = i;
-
-   if(l < (int)minHeap.size() && minHeap[l]->key < minHeap[i]->key)
-   {
-      smallest = l;
-   }
-   else 
-   {
-      smallest = i;
-   }
-   if(r < (int)minHeap.size() && minHeap[r]->key < minHeap[smallest]->key)
+   int size = (int)minHeap.size();
+   while (true)
    {
-      smallest = r;
-   }
-   if(smallest != i)
-   {
-      swap(minHeap[i],minHeap[smallest]);
-      if((int)minHeap.size() > 1)
-         minHeapify(smallest);
+      int l = left(i);
+      int r = right(i);
+      int smallest = i;
+
+      if(l < size && minHeap[l].key < minHeap[i].key)
+      {
+         smallest = l;
+      }
+      if(r < size && minHeap[r].key < minHeap[smallest].key)
+      {
+         smallest = r;
+      }
+      if(smallest == i)
+         return;
+      exchange(i,smallest);
+      i = smallest;
    }
 }
 
 /**
  * Desc: This function builds Min Heap by maintaining min Heap property.
  *
- * In:   None. 
+ * In:   None.
  * Out:  Returns nothing - Min Heap property of entire heap.
  *
  */
 
 void MinPriorityQ::buildMinHeap()
 {
-   if(minHeap.size() > 1)
-   {
-      for(int i = floor((int)minHeap.size()/2); i >= 0; i--)
-         minHeapify(i);
-   }
+   for(int i = (int)minHeap.size()/2 - 1; i >= 0; i--)
+      minHeapify(i);
+}
+
+/**
+ * Desc: Swaps two elements of the heap and records their new positions.
+ *
+ * In:   Integer, Integer - heap indices of the two elements.
+ *
+ */
+
+void MinPriorityQ::exchange(int i, int j)
+{
+   swap(minHeap[i], minHeap[j]);
+   position[minHeap[i].id] = i;
+   position[minHeap[j].id] = j;
 }
 
 /**
  * Desc: This Function looks for the parent of input integer.
- * 
+ *
  * In:   Integer - The input integer position whose parent is required.
  * Out:  Integer - The parent's position of input in the heap.
  *
@@ -234,12 +216,12 @@ void MinPriorityQ::buildMinHeap()
 
 int MinPriorityQ::parent(int i)
 {
-   return (floor(i/2));
+   return (i - 1) / 2;
 }
 
 /**
  * Desc: This Function looks for the left child of input integer.
- * 
+ *
  * In:   Integer - The input integer position whose left child is required.
  * Out:  Integer - The left child's position of input in the heap.
  *
@@ -247,12 +229,12 @@ int MinPriorityQ::parent(int i)
 
 int MinPriorityQ::left(int i)
 {
-   return (2*i);
+   return (2*i + 1);
 }
 
 /**
  * Desc: This Function looks for the right child of input integer.
- * 
+ *
  * In:   Integer - The input integer position whose right child is required.
  * Out:  Integer - The right child's position of input in the heap.
  *
@@ -260,5 +242,5 @@ int MinPriorityQ::left(int i)
 
 int MinPriorityQ::right(int i)
 {
-   return (2*i+1);
+   return (2*i + 2);
 }
@@ -11,41 +11,49 @@
 #ifndef ____minpriority__
 #define ____minpriority__
 
-#include <string>
 #include <vector>
+#include <stdint.h>
 
-
-using std::string;
 using std::vector;
 
+/*
+ * Ids are the dense 4-byte handles handed out by StringPool, so the heap
+ * position of every id is kept in a flat array and decreaseKey does not
+ * have to search the heap.
+ */
+
 class MinPriorityQ
 {
 public:
+   static const uint32_t EMPTY = 0xFFFFFFFFu; //extractMin() on empty queue
+
    MinPriorityQ();              // Constructor
    ~MinPriorityQ();             //Destructor
    
-   void insert(string,int);     //Function to insert an entry into heap
-   void decreaseKey(string,int);//Descreases key when new key is input
-   string extractMin();         //Extracts minimum from queue and removes it
-   bool isMember(string);       //Checks if the input id is present or not
+   void insert(uint32_t,int);   //Function to insert an entry into heap
+   void decreaseKey(uint32_t,int);//Descreases key when new key is input
+   uint32_t extractMin();       //Extracts minimum from queue and removes it
+   bool isMember(uint32_t);     //Checks if the input id is present or not
+   bool empty();                //True when no element is left
    
 private:
    class Element                //Private Class
    {
    public:
-      Element(string,int);      //Copy constructor
-      ~Element();               //Destructor
-      string id;                //String id to store 
+      Element(uint32_t,int);    //Copy constructor
+      uint32_t id;              //Id of the element
       int key;                  //Key int which is to be used and compared
    };
    
    void buildMinHeap();         //Function which builds heap after alteration
    void minHeapify(int);        //Called by buildMaxHeap () 
+   void exchange(int,int);      //Swaps two elements and their positions
    int parent(int);             //Fetches the parent of input
    int left(int);               //Fetches the left child of input
    int right(int);              //Fecthes the right chicldof input
 
-   vector<Element*> minHeap;    //Vector of type element which stores Heap
+   vector<Element> minHeap;     //Elements stored by value
+   vector<int> position;        //Heap index by id, -1 when not queued
 };
 
 #endif /* defined(____minpriority__) */
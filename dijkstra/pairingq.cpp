@@ -0,0 +1,115 @@
+/**
+ *  @file: pairingq.cpp
+ *  @desc: Implementation of the id queue on top of PairingHeap.
+ *
+ *  @author: Diney Wankhede
+ *  @date:  4/22/15
+ *
+ */
+
+#include "pairingq.h"
+#include <vector>
+
+const uint32_t PairingQ::EMPTY;
+
+/**
+ * Constructor and destructor for class PairingQ, the heap owns the nodes.
+ *
+ */
+
+PairingQ::PairingQ()
+{
+
+}
+
+PairingQ::~PairingQ()
+{
+
+}
+
+/**
+ * Desc: Function to insert an element into the queue.
+ *
+ * In:   uint32_t - Id - Handle of the element
+ *       Integer - Key - Key of type integer to min pq
+ *
+ */
+
+void PairingQ::insert(uint32_t id, int key)
+{
+   if (id >= handle.size())
+   {
+      handle.resize(id + 1, NULL);
+      extracted.resize(id + 1, 0);
+   }
+   handle[id] = heap.insert(id, key);
+}
+
+/**
+ * Desc: Function to decrease the key as and when an update is required.
+ *       An id which was never queued since reset() is inserted, one which
+ *       was extracted is ignored.
+ *
+ * In:   uint32_t - Id - Handle of the element
+ *       Integer - Key - Key of type integer to min pq
+ *
+ */
+
+void PairingQ::decreaseKey(uint32_t id, int key)
+{
+   if (isMember(id))
+      heap.decreaseKey(handle[id], key);
+   else if (id >= extracted.size() || !extracted[id])
+      insert(id, key);
+}
+
+/**
+ * Desc: Extracts and returns the id with the minimum key.
+ *
+ * In:   None
+ * Out:  uint32_t - Returns the minimum id, EMPTY if queue is empty.
+ */
+
+uint32_t PairingQ::extractMin()
+{
+   if (heap.empty())
+      return EMPTY;
+   uint32_t min = heap.extractMin();
+   handle[min] = NULL;
+   extracted[min] = 1;
+   return min;
+}
+
+/**
+ * Desc: This function checks if the input id is present in the queue or not.
+ *
+ */
+
+bool PairingQ::isMember(uint32_t id)
+{
+   return id < handle.size() && handle[id] != NULL;
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+bool PairingQ::empty()
+{
+   return heap.empty();
+}
+
+/**
+ * Desc: Removes every element and forgets which ids were extracted.
+ *
+ * In:   size_t - number of ids of the next search
+ *
+ */
+
+void PairingQ::reset(size_t n)
+{
+   heap.clear();
+   handle.assign(n, NULL);
+   extracted.assign(n, 0);
+}
@@ -0,0 +1,51 @@
+/**
+ *  @file: pairingq.h
+ *  @desc: Priority queue of dense 4-byte ids on top of the pairing heap of
+ *         min_prioirity_q, with the interface of MinPriorityQ so that the
+ *         Dijkstra code can use either one. The handle of every queued id
+ *         is kept in a flat array, so decreaseKey is an O(1) cut and link
+ *         plus an amortized o(log n) share of the next extract, instead
+ *         of the O(log n) sift of the binary heap.
+ *
+ *         After reset() the queue is filled lazily: decreaseKey of an id
+ *         which was never queued inserts it, so only the frontier of the
+ *         search is ever in the heap. Extracted ids are not inserted again.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____pairingq__
+#define ____pairingq__
+
+#include <vector>
+#include <stdint.h>
+#include "pairingheap.h"
+
+using std::vector;
+
+class PairingQ
+{
+public:
+   static const uint32_t EMPTY = 0xFFFFFFFFu; //extractMin() on empty queue
+
+   PairingQ();                  // Constructor
+   ~PairingQ();                 //Destructor
+
+   void insert(uint32_t,int);   //Function to insert an entry into heap
+   void decreaseKey(uint32_t,int);//Descreases key when new key is input
+   uint32_t extractMin();       //Extracts minimum from queue and removes it
+   bool isMember(uint32_t);     //Checks if the input id is present or not
+   bool empty();                //True when no element is left
+   void reset(size_t);          //Empties the queue for ids 0 .. n-1
+
+private:
+   typedef PairingHeap<uint32_t,int> Heap;
+
+   Heap heap;                   //Nodes of the queued ids
+   vector<Heap::Handle> handle; //Node by id, NULL when not queued
+   vector<char> extracted;      //Id left the queue since reset()
+};
+
+#endif /* defined(____pairingq__) */
@@ -13,25 +13,45 @@
 #include <string>
 #include <sstream>
 #include <limits>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 
 using std::cout;
 using std::cin;
 using std::string;
 using std::endl;
 using std::stringstream;
+using std::vector;
 
 /*
  * Desc: Main function for the initializing the program. Reads the entire 
- *       graph and then processes unlimited quries.
- * In:  None - Creates an object of class SSPapp and then reads the graph
- * Out: Returns integer  - 0
+ *       graph and then processes unlimited quries, from stdin or with
+ *       "--serve path [workers]" from clients of a Unix domain socket.
+ * In:  Integer, char** - command line arguments
+ * Out: Returns integer  - 0, 1 if the socket could not be set up
  *
  */
 
-int main()
+int main(int argc, char* argv[])
 {
    SSPapp mySSPapp;
    mySSPapp.readGraph();
+
+   if (argc > 2 && string(argv[1]) == "--serve")
+   {
+      int workers = argc > 3 ? atoi(argv[3]) : 0;
+      if (workers <= 0)
+         workers = (int)std::thread::hardware_concurrency();
+      return mySSPapp.serve(argv[2], workers > 0 ? workers : 4);
+   }
    
    while (!cin.eof())
    {
@@ -105,12 +125,22 @@ void SSPapp::readGraph()
       weightString =  entirePair.substr(0);
       stringstream ss;
       ss << weightString;
-      if (stringstream(weightString) >> weight)
+      if (ss >> weight)
       {  
          if (!from.empty() && !to.empty()) 
          {
-             myGraph.addEdge(from,to,weight);   //Add Edges to the adjList
-            
+            vector<int> costs(1, weight);        //Optional ,cost list
+            int time, cost;
+            while (ss.peek() == ',' && ss.get() && ss >> cost)
+               costs.push_back(cost);
+            vector<Graph::Breakpoint> profile;   //Optional time:cost pairs
+            char colon;
+            while (ss >> time >> colon >> cost && colon == ':')
+               profile.push_back(Graph::Breakpoint(time,cost));
+            if (profile.empty() && costs.size() == 1)
+               myGraph.addEdge(from,to,weight);  //Add Edges to the adjList
+            else
+               myGraph.addEdge(from,to,costs,profile);
          }
       }
    }
@@ -118,6 +148,11 @@ void SSPapp::readGraph()
 
 /*
  * Desc: Processes the queries until end of file
+ *       "from to" asks for the static shortest path,
+ *       "from to departure" for the fastest path leaving at departure,
+ *       which may not be negative,
+ *       "* from to" for every Pareto optimal path over all edge costs and
+ *       "! from via to" forbids that turn for the time-dependent queries.
  * In: None - Takes queries from user
  * 
  * Out: Returns nothing - Prints the output 
@@ -129,13 +164,171 @@ void SSPapp::processQueries()
    string query,from, to;
    getline(cin,query);
    
-   from = query.substr(0,query.find(' '));
-   query.erase(0,query.find(' ')+1);
-   to = query.substr(0,query.find(' '));
-   query.erase(0,query.find(' ')+1);
+   stringstream ss(query);
+   ss >> from >> to;
    
-   if (!from.empty() && !to.empty()) 
+   if (from == "!")                       //Turn restriction
+   {
+      string via, next;
+      if (ss >> via >> next)
+         myGraph.addTurnRestriction(to,via,next);
+      return;
+   }
+   myGraph.prepare();
+   string answer = answerQuery(query, mySearch);
+   if (!answer.empty())
+      cout<< answer << endl;
+}
+
+/*
+ * Desc: Answers one query on the prepared graph. Only reads the graph, so
+ *       worker threads may call it at the same time with their own Search.
+ * In:  string - query line, Graph::Search - state of the calling thread
+ * Out: string - the answer, empty for a blank or malformed line
+ *
+ */
+
+string SSPapp::answerQuery(const string& query, Graph::Search& search) const
+{
+   string from, to;
+   stringstream ss(query);
+   ss >> from >> to;
+
+   if (from == "!")
+      return "turn restrictions are read only while serving";
+   if (from == "*")                       //Pareto query
+   {
+      string target;
+      if (ss >> target)
+         return myGraph.getParetoPaths(to,target,search);
+   }
+   else if (!from.empty() && !to.empty()) 
    { 
-      cout<< myGraph.getShortestPath(from,to) << endl; //Getting shortest path
+      int departure;
+      if (ss >> departure)
+      {
+         if (departure < 0)
+            return "departure must not be negative";
+         return myGraph.getShortestPath(from,to,departure,search);
+      }
+      return myGraph.getShortestPath(from,to,search); //Shortest path
+   }
+   return "";
+}
+
+/*
+ * Desc: Listens on a Unix domain socket and answers queries with a pool of
+ *       worker threads. A client sends query lines in the stdin format and
+ *       gets every answer followed by an empty line, as the Pareto answers
+ *       span several lines. Runs until the process is killed.
+ * In:  string - socket path, a socket left there is replaced,
+ *       any other file is an error
+ *       Integer - number of worker threads
+ * Out: Integer - 1 if the socket could not be set up
+ *
+ */
+
+int SSPapp::serve(const string& path, int workers)
+{
+   myGraph.prepare();                     //Graph is read only from now on
+
+   sockaddr_un address;
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   if (path.size() >= sizeof(address.sun_path))
+   {
+      std::cerr << "socket path too long: " << path << endl;
+      return 1;
+   }
+   strcpy(address.sun_path, path.c_str());
+   struct stat info;
+   if (lstat(path.c_str(), &info) == 0)
+   {
+      if (!S_ISSOCK(info.st_mode))
+      {
+         std::cerr << path << " exists and is not a socket" << endl;
+         return 1;
+      }
+      unlink(path.c_str());               //Left over from an earlier run
+   }
+
+   int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (listenFd < 0
+       || bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0
+       || listen(listenFd, 128) < 0)
+   {
+      perror(path.c_str());
+      return 1;
+   }
+
+   vector<std::thread> pool;
+   for (int i = 0; i < workers; i++)
+      pool.push_back(std::thread(&SSPapp::acceptClients, this, listenFd));
+   for (size_t i = 0; i < pool.size(); i++)
+      pool[i].join();
+   close(listenFd);
+   return 0;
+}
+
+/*
+ * Desc: Loop of one worker thread. Takes the next waiting client and serves
+ *       it to the end. The Search lives as long as the worker, so its cached
+ *       tree is reused across queries and clients.
+ * In:  Integer - listening socket
+ *
+ */
+
+void SSPapp::acceptClients(int listenFd)
+{
+   Graph::Search search;
+   while (true)
+   {
+      int fd = accept(listenFd, NULL, NULL);
+      if (fd < 0)
+      {
+         if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+         return;
+      }
+      serveClient(fd, search);
+      close(fd);
+   }
+}
+
+/*
+ * Desc: Reads query lines from a client until it hangs up. Every complete
+ *       line of a read is answered and all its answers go back in one write.
+ * In:  Integer - connected socket, Graph::Search - state of the worker
+ *
+ */
+
+void SSPapp::serveClient(int fd, Graph::Search& search)
+{
+   char buffer[1 << 16];
+   string pending, reply;
+   ssize_t count;
+   while ((count = read(fd, buffer, sizeof(buffer))) > 0)
+   {
+      pending.append(buffer, count);
+      size_t start = 0, end;
+      while ((end = pending.find('\n', start)) != string::npos)
+      {
+         reply += answerQuery(pending.substr(start, end - start), search);
+         reply += "\n\n";
+         start = end + 1;
+      }
+      pending.erase(0, start);
+
+      for (size_t sent = 0; sent < reply.size(); )
+      {
+         ssize_t n = send(fd, reply.data() + sent, reply.size() - sent,
+                          MSG_NOSIGNAL);
+         if (n < 0 && errno == EINTR)
+            continue;
+         if (n <= 0)
+            return;                        //Client went away
+         sent += n;
+      }
+      reply.clear();
    }
 }
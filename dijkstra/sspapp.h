@@ -3,6 +3,10 @@
  *  @desc: SSPapp file which has functions to read the graph in entirity 
  *         and process queries.
  *
+ *         With --serve the queries come from clients of a Unix domain
+ *         socket instead of stdin. A pool of worker threads shares the read
+ *         only graph, each worker answers with its own Graph::Search.
+ *
  *  @author: Diney Wankhede
  *  @date:   4/26/15
  *
@@ -11,8 +15,11 @@
 #ifndef ____SSPapp__
 #define ____SSPapp__
 
+#include <string>
 #include "graph.h"
 
+using std::string;
+
 class SSPapp
 {
 public:
@@ -20,8 +27,14 @@ public:
    ~SSPapp();                 // Destructor
    void readGraph();          // Reading the entire graph
    void processQueries();     // Processing the queries
+   int serve(const string& path, int workers); // Answer queries on a socket
 private:
    Graph myGraph;             //Object of inner class Graph
+   Graph::Search mySearch;    //Query state of the stdin queries
+
+   string answerQuery(const string& query, Graph::Search&) const;
+   void acceptClients(int listenFd);          //Loop of one worker thread
+   void serveClient(int fd, Graph::Search&);  //All queries of one client
 };
 
 #endif /* defined(____SSPapp__) */
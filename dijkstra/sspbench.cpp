@@ -0,0 +1,618 @@
+/**
+ *  @file: sspbench.cpp
+ *  @desc: Benchmark driver for the shortest path engines of the Graph class.
+ *         Synthetic graphs (grid, random geometric, power-law, road-like and
+ *         dense random)
+ *         are generated with a fixed seed, loaded into every engine and
+ *         queried with random source/target pairs. Load time, preprocessing
+ *         time and query latency percentiles are printed as CSV so that the
+ *         results can be tracked across releases.
+ *
+ *         Usage: sspbench [-g grid|geometric|powerlaw|road|dense|all]
+ *                         [-n vertices]
+ *                         [-q queries] [-s seed] [-e engine]
+ *
+ *  @author: Diney Wankhede
+ *  @date:  4/26/15
+ *
+ */
+
+#include "graph.h"
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+using std::to_string;
+using std::mt19937;
+using std::uniform_int_distribution;
+using std::uniform_real_distribution;
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Desc: Edge of a generated graph, names are resolved through GraphData.
+ */
+
+struct GenEdge
+{
+   int from;
+   int to;
+   int weight;
+};
+
+/*
+ * Desc: A generated graph, vertex i is named names[i].
+ */
+
+struct GraphData
+{
+   string kind;
+   vector<string> names;
+   vector<GenEdge> edges;
+};
+
+/*
+ * Desc: Shortest path engine under benchmark. Every engine gets its own
+ *       Graph object so no state is shared between two engines.
+ */
+
+struct Engine
+{
+   const char* name;
+   void (*load)(Graph&, const GraphData&);       //Builds the graph
+   void (*preprocess)(Graph&);                   //One time work, may be empty
+   string (*query)(Graph&, const string&, const string&);
+};
+
+/*
+ * Desc: Latency summary of a batch of queries in microseconds.
+ */
+
+struct Summary
+{
+   double p50;
+   double p90;
+   double p99;
+   double max;
+   double mean;
+};
+
+/*
+ * Desc: Milliseconds elapsed between two clock readings.
+ */
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end)
+{
+   return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/*
+ * Desc: Adds an edge in both directions.
+ */
+
+static void addBoth(GraphData& g, int a, int b, int weight)
+{
+   GenEdge e1 = {a, b, weight};
+   GenEdge e2 = {b, a, weight};
+   g.edges.push_back(e1);
+   g.edges.push_back(e2);
+}
+
+/*
+ * Desc: Names the vertices v0 .. v(n-1).
+ */
+
+static void nameVertices(GraphData& g, int n)
+{
+   g.names.resize(n);
+   for (int i = 0; i < n; i++)
+      g.names[i] = "v" + to_string(i);
+}
+
+/*
+ * Desc: Square grid with 4-neighbours and uniform random weights 1..10.
+ *
+ * In:   int n - number of vertices requested, rounded down to a square
+ *       mt19937& rng - random generator
+ * Out:  GraphData - the generated graph
+ */
+
+static GraphData makeGrid(int n, mt19937& rng)
+{
+   GraphData g;
+   g.kind = "grid";
+   int side = std::max(2, (int)std::sqrt((double)n));
+   nameVertices(g, side * side);
+   uniform_int_distribution<int> weight(1, 10);
+
+   for (int r = 0; r < side; r++)
+   {
+      for (int c = 0; c < side; c++)
+      {
+         int v = r * side + c;
+         if (c + 1 < side)
+            addBoth(g, v, v + 1, weight(rng));
+         if (r + 1 < side)
+            addBoth(g, v, v + side, weight(rng));
+      }
+   }
+   return g;
+}
+
+/*
+ * Desc: Random geometric graph. Points are placed in the unit square and
+ *       connected when closer than a radius chosen for an average degree
+ *       of about 8. Weights are the scaled euclidean distances.
+ */
+
+static GraphData makeGeometric(int n, mt19937& rng)
+{
+   GraphData g;
+   g.kind = "geometric";
+   nameVertices(g, n);
+   uniform_real_distribution<double> coord(0.0, 1.0);
+   vector<double> x(n), y(n);
+   for (int i = 0; i < n; i++)
+   {
+      x[i] = coord(rng);
+      y[i] = coord(rng);
+   }
+
+   double radius = std::sqrt(8.0 / (3.14159265358979 * n));
+   int cells = std::max(1, (int)(1.0 / radius));
+   vector<vector<int>> grid(cells * cells);       //Bucketing by cell
+   for (int i = 0; i < n; i++)
+   {
+      int cx = std::min(cells - 1, (int)(x[i] * cells));
+      int cy = std::min(cells - 1, (int)(y[i] * cells));
+      grid[cy * cells + cx].push_back(i);
+   }
+
+   for (int i = 0; i < n; i++)
+   {
+      int cx = std::min(cells - 1, (int)(x[i] * cells));
+      int cy = std::min(cells - 1, (int)(y[i] * cells));
+      for (int dy = -1; dy <= 1; dy++)
+      {
+         for (int dx = -1; dx <= 1; dx++)
+         {
+            int nx = cx + dx, ny = cy + dy;
+            if (nx < 0 || ny < 0 || nx >= cells || ny >= cells)
+               continue;
+            const vector<int>& cell = grid[ny * cells + nx];
+            for (size_t k = 0; k < cell.size(); k++)
+            {
+               int j = cell[k];
+               if (j <= i)
+                  continue;
+               double d = std::hypot(x[i] - x[j], y[i] - y[j]);
+               if (d < radius)
+                  addBoth(g, i, j, 1 + (int)(d * 1000.0));
+            }
+         }
+      }
+   }
+   return g;
+}
+
+/*
+ * Desc: Power-law graph using Barabasi-Albert preferential attachment,
+ *       every new vertex attaches to 3 existing ones.
+ */
+
+static GraphData makePowerLaw(int n, mt19937& rng)
+{
+   GraphData g;
+   g.kind = "powerlaw";
+   nameVertices(g, n);
+   const int m = 3;
+   vector<int> targets;                          //Vertex repeated by degree
+   uniform_int_distribution<int> weight(1, 10);
+
+   for (int i = 1; i <= m && i < n; i++)          //Small seed clique
+   {
+      for (int j = 0; j < i; j++)
+      {
+         addBoth(g, i, j, weight(rng));
+         targets.push_back(i);
+         targets.push_back(j);
+      }
+   }
+   for (int i = m + 1; i < n; i++)
+   {
+      for (int k = 0; k < m; k++)
+      {
+         uniform_int_distribution<size_t> pick(0, targets.size() - 1);
+         int j = targets[pick(rng)];
+         addBoth(g, i, j, weight(rng));
+         targets.push_back(i);
+         targets.push_back(j);
+      }
+   }
+   return g;
+}
+
+/*
+ * Desc: Road-like graph. A grid of local streets with random detours
+ *       removed, plus a sparse lattice of fast highways every 8 blocks
+ *       whose weight per block is lower than the local streets.
+ */
+
+static GraphData makeRoad(int n, mt19937& rng)
+{
+   GraphData g;
+   g.kind = "road";
+   int side = std::max(2, (int)std::sqrt((double)n));
+   nameVertices(g, side * side);
+   uniform_int_distribution<int> weight(5, 20);
+   uniform_int_distribution<int> percent(0, 99);
+   const int spacing = 8;
+
+   for (int r = 0; r < side; r++)
+   {
+      for (int c = 0; c < side; c++)
+      {
+         int v = r * side + c;
+         bool highwayRow = (r % spacing == 0);
+         bool highwayCol = (c % spacing == 0);
+         if (c + 1 < side && (highwayRow || percent(rng) < 85))
+            addBoth(g, v, v + 1, highwayRow ? 2 : weight(rng));
+         if (r + 1 < side && (highwayCol || percent(rng) < 85))
+            addBoth(g, v, v + side, highwayCol ? 2 : weight(rng));
+      }
+   }
+   return g;
+}
+
+/*
+ * Desc: Dense random graph, every vertex has 32 out edges to uniformly
+ *       random vertices with weights 1..1000. Many edges improve a tentative
+ *       distance, so queries are dominated by decreaseKey.
+ */
+
+static GraphData makeDense(int n, mt19937& rng)
+{
+   GraphData g;
+   g.kind = "dense";
+   nameVertices(g, n);
+   const int degree = 32;
+   uniform_int_distribution<int> target(0, std::max(0, n - 1));
+   uniform_int_distribution<int> weight(1, 1000);
+   for (int i = 0; i < n; i++)
+   {
+      for (int k = 0; k < degree; k++)
+      {
+         GenEdge e = {i, target(rng), weight(rng)};
+         g.edges.push_back(e);
+      }
+   }
+   return g;
+}
+
+/*
+ * Desc: Builds one of the synthetic graphs by name.
+ */
+
+static bool makeGraph(const string& kind, int n, mt19937& rng, GraphData& g)
+{
+   if (kind == "grid")
+      g = makeGrid(n, rng);
+   else if (kind == "geometric")
+      g = makeGeometric(n, rng);
+   else if (kind == "powerlaw")
+      g = makePowerLaw(n, rng);
+   else if (kind == "road")
+      g = makeRoad(n, rng);
+   else if (kind == "dense")
+      g = makeDense(n, rng);
+   else
+      return false;
+   return true;
+}
+
+/*
+ * Desc: Engine callbacks for the classic buildSSPTree implementation.
+ */
+
+static void loadBaseline(Graph& graph, const GraphData& g)
+{
+   for (size_t i = 0; i < g.names.size(); i++)
+      graph.addVertex(g.names[i]);
+   for (size_t i = 0; i < g.edges.size(); i++)
+      graph.addEdge(g.names[g.edges[i].from], g.names[g.edges[i].to],
+                    g.edges[i].weight);
+}
+
+static void preprocessBaseline(Graph& graph)
+{
+   graph.sortNeighbors();
+}
+
+static string queryBaseline(Graph& graph, const string& from, const string& to)
+{
+   return graph.getShortestPath(from, to);
+}
+
+/*
+ * Desc: The classic engine with buildSSPTree on the pairing heap.
+ */
+
+static void loadPairingHeap(Graph& graph, const GraphData& g)
+{
+   graph.setQueue(Graph::PAIRING_HEAP);
+   loadBaseline(graph, g);
+}
+
+/*
+ * Desc: Engine callbacks for the time-dependent search. Every tenth edge
+ *       gets a rush hour profile tripling its cost around time 500, the
+ *       rest keep a constant cost. Queries depart at time 400.
+ */
+
+static void loadTimeDependent(Graph& graph, const GraphData& g)
+{
+   for (size_t i = 0; i < g.names.size(); i++)
+      graph.addVertex(g.names[i]);
+   for (size_t i = 0; i < g.edges.size(); i++)
+   {
+      const GenEdge& e = g.edges[i];
+      if (i % 10 != 0)
+      {
+         graph.addEdge(g.names[e.from], g.names[e.to], e.weight);
+         continue;
+      }
+      vector<Graph::Breakpoint> profile;
+      profile.push_back(Graph::Breakpoint(0, e.weight));
+      profile.push_back(Graph::Breakpoint(500, 3 * e.weight));
+      profile.push_back(Graph::Breakpoint(1000, e.weight));
+      graph.addEdge(g.names[e.from], g.names[e.to], e.weight, profile);
+   }
+}
+
+static string queryTimeDependent(Graph& graph, const string& from,
+                                 const string& to)
+{
+   return graph.getShortestPath(from, to, 400);
+}
+
+/*
+ * Desc: Same as loadTimeDependent plus a U-turn ban on every tenth edge.
+ */
+
+static void loadTurnRestricted(Graph& graph, const GraphData& g)
+{
+   loadTimeDependent(graph, g);
+   for (size_t i = 0; i < g.edges.size(); i += 10)
+   {
+      const GenEdge& e = g.edges[i];
+      graph.addTurnRestriction(g.names[e.from], g.names[e.to],
+                               g.names[e.from]);
+   }
+}
+
+/*
+ * Desc: Engine callbacks for the Pareto search. Every edge gets a toll
+ *       which is high on cheap edges, so distance and toll conflict.
+ */
+
+static void loadPareto(Graph& graph, const GraphData& g)
+{
+   for (size_t i = 0; i < g.names.size(); i++)
+      graph.addVertex(g.names[i]);
+   vector<int> costs(2);
+   for (size_t i = 0; i < g.edges.size(); i++)
+   {
+      const GenEdge& e = g.edges[i];
+      costs[0] = e.weight;
+      costs[1] = (e.from + e.to) % 2 == 0 ? 0 : std::max(0, 12 - e.weight);
+      graph.addEdge(g.names[e.from], g.names[e.to], costs);
+   }
+}
+
+static string queryPareto(Graph& graph, const string& from, const string& to)
+{
+   return graph.getParetoPaths(from, to);
+}
+
+static const Engine engines[] =
+{
+   {"buildSSPTree", loadBaseline, preprocessBaseline, queryBaseline},
+   {"pairingHeap", loadPairingHeap, preprocessBaseline, queryBaseline},
+   {"timeDependent", loadTimeDependent, preprocessBaseline,
+    queryTimeDependent},
+   {"turnRestricted", loadTurnRestricted, preprocessBaseline,
+    queryTimeDependent},
+   {"pareto", loadPareto, preprocessBaseline, queryPareto},
+};
+
+/*
+ * Desc: Nearest-rank percentiles of the latencies, which are sorted here.
+ */
+
+static Summary summarize(vector<double>& latencies)
+{
+   Summary s = {0.0, 0.0, 0.0, 0.0, 0.0};
+   if (latencies.empty())
+      return s;
+   std::sort(latencies.begin(), latencies.end());
+   size_t n = latencies.size();
+   double total = 0.0;
+   for (size_t i = 0; i < n; i++)
+      total += latencies[i];
+   s.p50 = latencies[(n - 1) * 50 / 100];
+   s.p90 = latencies[(n - 1) * 90 / 100];
+   s.p99 = latencies[(n - 1) * 99 / 100];
+   s.max = latencies[n - 1];
+   s.mean = total / n;
+   return s;
+}
+
+/*
+ * Desc: Runs one engine on one graph and prints a CSV row.
+ *
+ * In:   Engine - engine to run
+ *       GraphData - graph to load
+ *       vector<pair> - query pairs shared by every engine
+ * Out:  Prints one line of results.
+ */
+
+static void runEngine(const Engine& engine, const GraphData& g,
+                      const vector<std::pair<int,int>>& queries)
+{
+   Graph graph;
+   Clock::time_point t0 = Clock::now();
+   engine.load(graph, g);
+   Clock::time_point t1 = Clock::now();
+   engine.preprocess(graph);
+   Clock::time_point t2 = Clock::now();
+
+   vector<double> latencies;
+   size_t checksum = 0;                          //Keeps answers observable
+   for (size_t i = 0; i < queries.size(); i++)
+   {
+      Clock::time_point q0 = Clock::now();
+      string answer = engine.query(graph, g.names[queries[i].first],
+                                   g.names[queries[i].second]);
+      Clock::time_point q1 = Clock::now();
+      checksum += answer.size();
+      latencies.push_back(elapsedMs(q0, q1) * 1000.0);
+   }
+   Summary s = summarize(latencies);
+
+   cout << engine.name << "," << g.kind << "," << g.names.size() << ","
+        << g.edges.size() << "," << elapsedMs(t0, t1) << ","
+        << elapsedMs(t1, t2) << "," << queries.size() << ","
+        << s.mean << "," << s.p50 << "," << s.p90 << "," << s.p99 << ","
+        << s.max << "," << graph.memoryUsage() << "," << checksum << endl;
+}
+
+/*
+ * Desc: Parses a whole decimal number of at least low.
+ * In:  string - the text, Integer - smallest allowed value, Integer - result
+ * Out: bool - false when the text is not such a number
+ */
+
+static bool parseCount(const string& text, long low, int& value)
+{
+   char* end;
+   errno = 0;
+   long parsed = strtol(text.c_str(), &end, 10);
+   if (text.empty() || *end != '\0' || errno != 0 || parsed < low
+       || parsed > INT_MAX)
+      return false;
+   value = (int)parsed;
+   return true;
+}
+
+/*
+ * Desc: Prints how to call sspbench.
+ * Out: Integer - exit status 1
+ */
+
+static int usage()
+{
+   cerr << "usage: sspbench [-g grid|geometric|powerlaw|road|dense|all]"
+        << " [-n vertices >= 1] [-q queries] [-s seed] [-e engine]" << endl;
+   return 1;
+}
+
+/*
+ * Desc: Parses the options, generates the graphs and runs every engine.
+ */
+
+int main(int argc, char* argv[])
+{
+   string kind = "all";
+   string only;
+   int n = 1000;
+   int queryCount = 20;
+   unsigned seed = 42;
+
+   for (int i = 1; i < argc; i += 2)
+   {
+      string opt = argv[i];
+      if (i + 1 == argc)
+      {
+         cerr << "option " << opt << " needs a value" << endl;
+         return usage();
+      }
+      string val = argv[i + 1];
+      if (opt == "-g")
+         kind = val;
+      else if (opt == "-n")
+      {
+         if (!parseCount(val, 1, n))
+         {
+            cerr << "-n needs a number of vertices of at least 1" << endl;
+            return usage();
+         }
+      }
+      else if (opt == "-q")
+      {
+         if (!parseCount(val, 0, queryCount))
+         {
+            cerr << "-q needs a number of queries" << endl;
+            return usage();
+         }
+      }
+      else if (opt == "-s")
+         seed = (unsigned)strtoul(val.c_str(), NULL, 10);
+      else if (opt == "-e")
+         only = val;
+      else
+      {
+         cerr << "unknown option " << opt << endl;
+         return usage();
+      }
+   }
+
+   vector<string> kinds;
+   if (kind == "all")
+   {
+      kinds.push_back("grid");
+      kinds.push_back("geometric");
+      kinds.push_back("powerlaw");
+      kinds.push_back("road");
+      kinds.push_back("dense");
+   }
+   else
+      kinds.push_back(kind);
+
+   cout << "engine,graph,vertices,edges,load_ms,preprocess_ms,queries,"
+        << "mean_us,p50_us,p90_us,p99_us,max_us,memory_bytes,checksum" << endl;
+
+   for (size_t k = 0; k < kinds.size(); k++)
+   {
+      mt19937 rng(seed);
+      GraphData g;
+      if (!makeGraph(kinds[k], n, rng, g))
+      {
+         cerr << "unknown graph " << kinds[k] << endl;
+         return 1;
+      }
+      uniform_int_distribution<int> pick(0, (int)g.names.size() - 1);
+      vector<std::pair<int,int>> queries;
+      for (int i = 0; i < queryCount; i++)
+         queries.push_back(std::make_pair(pick(rng), pick(rng)));
+
+      for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+      {
+         if (only.empty() || only == engines[e].name)
+            runEngine(engines[e], g, queries);
+      }
+   }
+   return 0;
+}
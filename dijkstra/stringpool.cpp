@@ -0,0 +1,206 @@
+/**
+ *  @file: stringpool.cpp
+ *  @desc: Implementation of the string interning arena. Strings are copied
+ *         into 64KB character blocks and looked up through an open
+ *         addressing table of ids with linear probing.
+ *
+ *  @author: Diney Wankhede
+ *  @date:  4/26/15
+ *
+ */
+
+#include "stringpool.h"
+#include <string>
+#include <vector>
+#include <cstring>
+
+using std::string;
+using std::vector;
+
+static const size_t BLOCK_SIZE = 1 << 16;         //Bytes per arena block
+
+const StringPool::Id StringPool::NONE;
+
+/*
+ * Desc: Constructor, starts with an empty table of 16 slots.
+ *
+ */
+
+StringPool::StringPool()
+{
+   blockUsed = BLOCK_SIZE;                        //Forces a first block
+   slots.assign(16, NONE);
+}
+
+/*
+ * Desc: Destructor which frees every character block.
+ *
+ */
+
+StringPool::~StringPool()
+{
+   for (size_t i = 0; i < blocks.size(); i++)
+      delete [] blocks[i];
+}
+
+/*
+ * Desc: FNV-1a hash of a character range.
+ *
+ * In:   const char* - start of the characters
+ *       size_t - number of characters
+ * Out:  uint32_t - hash value
+ */
+
+uint32_t StringPool::hashOf(const char* s, size_t n)
+{
+   uint32_t hash = 2166136261u;
+   for (size_t i = 0; i < n; i++)
+   {
+      hash ^= (unsigned char)s[i];
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+/*
+ * Desc: Copies a string into the arena. Strings larger than a block get a
+ *       block of their own so that no string ever straddles two blocks.
+ *
+ * In:   string - characters to copy
+ * Out:  const char* - start of the stable copy
+ */
+
+const char* StringPool::store(const string& s)
+{
+   if (s.size() > BLOCK_SIZE / 4)
+   {
+      char* own = new char[s.size() + 1];
+      memcpy(own, s.data(), s.size());
+      own[s.size()] = '\0';
+      blocks.insert(blocks.end() - (blocks.empty() ? 0 : 1), own);
+      return own;
+   }
+   if (blockUsed + s.size() + 1 > BLOCK_SIZE)
+   {
+      blocks.push_back(new char[BLOCK_SIZE]);
+      blockUsed = 0;
+   }
+   char* dest = blocks.back() + blockUsed;
+   memcpy(dest, s.data(), s.size());
+   dest[s.size()] = '\0';
+   blockUsed += s.size() + 1;
+   return dest;
+}
+
+/*
+ * Desc: Doubles the slot table and reinserts every id.
+ *
+ */
+
+void StringPool::grow()
+{
+   vector<Id> bigger(slots.size() * 2, NONE);
+   size_t mask = bigger.size() - 1;
+   for (Id id = 0; id < (Id)starts.size(); id++)
+   {
+      size_t i = hashOf(starts[id], lengths[id]) & mask;
+      while (bigger[i] != NONE)
+         i = (i + 1) & mask;
+      bigger[i] = id;
+   }
+   slots.swap(bigger);
+}
+
+/*
+ * Desc: Looks up a string without adding it.
+ *
+ * In:   string - the string to look for
+ * Out:  Id - id of the string or NONE if it was never interned
+ */
+
+StringPool::Id StringPool::find(const string& s) const
+{
+   size_t mask = slots.size() - 1;
+   size_t i = hashOf(s.data(), s.size()) & mask;
+   StringView key(s.data(), (uint32_t)s.size());
+   while (slots[i] != NONE)
+   {
+      if (view(slots[i]) == key)
+         return slots[i];
+      i = (i + 1) & mask;
+   }
+   return NONE;
+}
+
+/*
+ * Desc: Returns the id of a string, adding the string on first use.
+ *       Ids are handed out densely from 0 in order of first use.
+ *
+ * In:   string - the string to intern
+ * Out:  Id - the stable id of the string
+ */
+
+StringPool::Id StringPool::intern(const string& s)
+{
+   if ((starts.size() + 1) * 2 > slots.size())    //Keep load under 1/2
+      grow();
+
+   size_t mask = slots.size() - 1;
+   size_t i = hashOf(s.data(), s.size()) & mask;
+   StringView key(s.data(), (uint32_t)s.size());
+   while (slots[i] != NONE)
+   {
+      if (view(slots[i]) == key)
+         return slots[i];
+      i = (i + 1) & mask;
+   }
+
+   Id id = (Id)starts.size();
+   starts.push_back(store(s));
+   lengths.push_back((uint32_t)s.size());
+   slots[i] = id;
+   return id;
+}
+
+/*
+ * Desc: View of an interned string, valid as long as the pool.
+ *
+ */
+
+StringView StringPool::view(Id id) const
+{
+   return StringView(starts[id], lengths[id]);
+}
+
+/*
+ * Desc: Copy of an interned string.
+ *
+ */
+
+string StringPool::str(Id id) const
+{
+   return string(starts[id], lengths[id]);
+}
+
+/*
+ * Desc: Number of distinct strings in the pool.
+ *
+ */
+
+size_t StringPool::size() const
+{
+   return starts.size();
+}
+
+/*
+ * Desc: Approximate memory held by the pool in bytes.
+ *
+ */
+
+size_t StringPool::bytes() const
+{
+   return blocks.size() * BLOCK_SIZE
+          + starts.capacity() * sizeof(const char*)
+          + lengths.capacity() * sizeof(uint32_t)
+          + slots.capacity() * sizeof(Id);
+}
@@ -0,0 +1,80 @@
+/**
+ *  @file: stringpool.h
+ *  @desc: String interning arena. Every distinct string is stored once in
+ *         large character blocks and is identified by a dense 4-byte id.
+ *         Ids and the views handed out stay valid for the lifetime of the
+ *         pool, blocks are never moved or freed while the pool is alive.
+ *
+ *  @author: Diney Wankhede
+ *  @date:  4/26/15
+ *
+ */
+
+#ifndef ____stringpool__
+#define ____stringpool__
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+
+/*
+ * Desc: Non owning view of an interned string. Compares like std::string.
+ */
+
+class StringView
+{
+public:
+   StringView() : data(NULL), length(0) {}
+   StringView(const char* d, uint32_t l) : data(d), length(l) {}
+   string str() const { return string(data, length); }
+
+   bool operator==(const StringView& o) const
+   {
+      return length == o.length && memcmp(data, o.data, length) == 0;
+   }
+   bool operator<(const StringView& o) const
+   {
+      int c = memcmp(data, o.data, length < o.length ? length : o.length);
+      return c < 0 || (c == 0 && length < o.length);
+   }
+
+   const char* data;
+   uint32_t length;
+};
+
+class StringPool
+{
+public:
+   typedef uint32_t Id;
+   static const Id NONE = 0xFFFFFFFFu;            //Id of a missing string
+
+   StringPool();                                  //Constructor
+   ~StringPool();                                 //Destructor
+
+   Id intern(const string&);                      //Id of string, adds it
+   Id find(const string&) const;                  //Id of string or NONE
+   StringView view(Id) const;                     //Stable view of an id
+   string str(Id) const;                          //Copy of an id's string
+   size_t size() const;                           //Number of strings
+   size_t bytes() const;                          //Memory held by the pool
+
+private:
+   StringPool(const StringPool&);                 //Not copyable
+   StringPool& operator=(const StringPool&);
+
+   static uint32_t hashOf(const char*, size_t);   //FNV-1a
+   const char* store(const string&);              //Copies into a block
+   void grow();                                   //Doubles the slot table
+
+   vector<char*> blocks;                          //Character arena
+   size_t blockUsed;                              //Bytes used in last block
+   vector<const char*> starts;                    //String start by id
+   vector<uint32_t> lengths;                      //String length by id
+   vector<Id> slots;                              //Open addressing by hash
+};
+
+#endif /* defined(____stringpool__) */
@@ -1,38 +1,138 @@
 /**
  *  @file: hash.cpp
  *  @desc: hash.cpp has functions which implements hash table and printing
- *         the statistics as required. 
+ *         the statistics as required.
+ *
+ *         The words are stored by open addressing in the manner of a Swiss
+ *         table. Every slot has a control byte, empty, deleted, or 7 bits
+ *         of the word's hash when full, and the bytes of 8 slots are
+ *         matched against the wanted 7 bits in one 64 bit word. Only slots
+ *         whose byte matches get their word compared, so a lookup mostly
+ *         reads one run of control bytes and one word. The words themselves
+ *         sit back to back in one arena and a slot holds their offset and
+ *         length, an insert allocates no node of its own.
+ *
+ *         Every slot also keeps the full hash of its word. A word is hashed
+ *         once per call, a slot whose hash differs is passed over without
+ *         touching the arena, and rebuilds and print never hash again.
+ *
+ *         A word's bucket is the slot its probe starts at, so the buckets
+ *         print and the statistics are about are the slots themselves. The
+ *         number of slots doubles whenever the words would exceed the max
+ *         load factor, which open addressing caps at 7/8. Growing does not
+ *         move every word at once: the full table is kept as the old one
+ *         and every insert moves a few of its buckets, and the bucket of
+ *         the word at hand, into the new one. Search looks in both while
+ *         that lasts. Words keep their place in the arena throughout.
  *
  *  @author Diney Wankhede on 3/17/15
  *
  */
 
 #include <string>
-#include <list>
+#include <vector>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <utility>
+#include <new>
+#include <stdexcept>
 #include "hash.h"
 
 using std::string;
-using std::list;
+using std::vector;
 
 using namespace std;
 
+static const signed char EMPTY = -128;          // 0b10000000
+static const signed char DELETED = -2;          // 0b11111110
+static const uint64_t LSBS = 0x0101010101010101ull;
+static const uint64_t MSBS = 0x8080808080808080ull;
+
+/**
+ * Desc: Spreads the bits of hashOf's hash, whose low bits alone do not
+ *       tell words apart well enough for slots and control bytes.
+ *
+ */
+
+static uint32_t mix(unsigned int hash)
+{
+   uint32_t mixed = hash * 0x9E3779B1u;
+   return mixed ^ (mixed >> 15);
+}
+
+/**
+ * Desc: The control bytes of a group as one word, byte i of the group
+ *       in bits 8i .. 8i+7 (little endian).
+ *
+ */
+
+static uint64_t loadGroup(const signed char* group)
+{
+   uint64_t bytes;
+   memcpy(&bytes, group, sizeof(bytes));
+   return bytes;
+}
+
+/**
+ * Desc: Sets the top bit of every byte of a group equal to tag. A byte
+ *       above a true match may be set falsely, the caller checks.
+ *
+ */
+
+static uint64_t matchTag(uint64_t group, signed char tag)
+{
+   uint64_t x = group ^ (LSBS * (unsigned char)tag);
+   return (x - LSBS) & ~x & MSBS;
+}
+
+static uint64_t matchEmpty(uint64_t group)
+{
+   return group & (~group << 6) & MSBS;
+}
+
+static uint64_t matchEmptyOrDeleted(uint64_t group)
+{
+   return group & (~group << 7) & MSBS;
+}
+
+/**
+ * Desc: Index in its group of the lowest byte set in a match.
+ *
+ */
+
+static size_t lowest(uint64_t match)
+{
+   return __builtin_ctzll(match) >> 3;
+}
+
 /**
  * Constructor for the hash.h initializing various variables
  * Initializes private member variables declared in hash.h.
+ *
+ * In:   size_t - buckets to start with, rounded up to a power of two,
+ *       double - max load factor, kept between 1/8 and 7/8
  */
 
-Hash::Hash()
+Hash::Hash(size_t buckets, double load)
 {
-   avgLength = 0.0;           
+   avgLength = 0.0;
    collisions = 0;
    longestList = 0;
    currentAvgListLen = 0.0;
+   maxLoad = std::min(std::max(load, 0.125), 0.875);
+   size_t capacity = GROUP;
+   while(capacity < buckets)
+      capacity *= 2;
+   reset(table, capacity);
+   old = Table();
+   cursor = 0;
+   deadBytes = 0;
 }
 
 /**
- * Desc: This function inputs the file name and extracts each word from the 
+ * Desc: This function inputs the file name and extracts each word from the
  *       file, calls hash_function and inserts the word using the index in the
  *       hash_table.
  * In:   string - file name from which the input is to be taken
@@ -45,115 +145,92 @@ void Hash::processFile(string fname)
    string word;
    while(getline(file,word))                     //process all the words
    {
-      int index = hf(word);
-      if(!hashTable[index].empty())
+      unsigned int size = insert(word, hashOf(word.data(), word.length()));
+      if(size > 1)                              //adding to hashtable
       {
          collisions++;
       }
-      hashTable[index].push_back(word);         //adding to hashtable
 
-      if (hashTable[index].size() >= longestList) 
+      if (size >= longestList)
       {
-         longestList = hashTable[index].size();//calculating longest list ever
+         longestList = size;                   //calculating longest list ever
       }
-      averageLength();                        //AverageLenght over time after 
+      averageLength();                        //AverageLenght over time after
    }                                          //insert
 }
-            
+
 /**
  * Desc: A functions which locates the input word in the hash tables & returns
  *       true or false accordingly.(true if present
  *
  * In:   String - The word that is to be searched in the hashtable
- * Out:  bool- Returns true if the input word is present in the hashtable 
+ * Out:  bool- Returns true if the input word is present in the hashtable
  *       else false.
  */
 
 bool Hash::search(string search)
 {
-   int index = hf(search);
-   if(!hashTable[index].empty())           // Checking Non empty only
-   {
-      for(int i = 0;i < HASH_TABLE_SIZE; i++)    
-      {
-         for(list<string>::iterator it = hashTable[i].begin();
-             it !=hashTable[i].end(); ++it)
-         {  
-            if(*it == search)
-              return true;
-         }
-      }
-   }  
-   return false;
+   unsigned int hash = hashOf(search.data(), search.length());
+   if(find(table, search, hash) != NONE)
+      return true;
+   return old.capacity != 0 && find(old, search, hash) != NONE;
 }
-            
+
 /**
- *  Desc: A function which removes the input word from the hashtable and 
- *        updates the avergeLength.
+ *  Desc: A function which removes the input word from the hashtable and
+ *        updates the avergeLength. Every copy of the word goes, as
+ *        list::remove did.
  *
  *  In:   String - The word that is to be removed from the hashtable
- *  Out:  Removes the input word and updates statistics 
+ *  Out:  Removes the input word and updates statistics
  *
  */
 
 void Hash::remove(string word)
 {
-   int index = hf(word);
-   if(!hashTable[index].empty())
+   unsigned int hash = hashOf(word.data(), word.length());
+   if(old.capacity != 0)
+      drain(bucketOf(hash, old.capacity));
+   size_t slot = find(table, word, hash);
+   if(slot == NONE)
+      return;
+   while(slot != NONE)
    {
-      if( search(word) ==  true)          // If word found proceed
-      {
-         hashTable[index].remove(word);   // Removes the words from hashtable
-         averageLength();                 // AverageLength after remove
-      }
+      deadBytes += table.entries[slot].length;
+      erase(table, slot);
+      slot = find(table, word, hash);
    }
+   averageLength();                          // AverageLength after remove
+   if(deadBytes > 4096 && deadBytes > arena.size() / 2)
+      compact();                             // Gives back the dead bytes
 }
-            
+
 /**
  *  Desc: A function which prints the hashtable according to index generated
  *
  *  In:   No input.Uses the hashtable
  *  Out:  Prints the hashtable with the index
  */
-            
+
 void Hash::print()
 {
-   for(int i = 0;i < HASH_TABLE_SIZE;i++)
-   {
-      cout << i << ":\t";
-      for(list<string>::iterator it = hashTable[i].begin(); 
-          it != hashTable[i].end(); ++it)
-      {
-         cout << *it << ", ";
-      }
-      cout << endl;
-   }  
+   writeTable(cout);
 }
 
-            
+
 /**
- *  Desc: The function outputs everything to a file similar to the print 
+ *  Desc: The function outputs everything to a file similar to the print
  *        function
  *
- *  In:   String- filename to which the output is to be written 
+ *  In:   String- filename to which the output is to be written
  *  Out:  The output is written to a file specified by the user
  */
-         
+
 void Hash::output(string filename)
 {
    ofstream fileObj;
    fileObj.open(filename);                   // Writing to a file(opens it)
-   
-   for(int i = 0;i < HASH_TABLE_SIZE;i++)
-   {
-      fileObj << i << ":\t";
-      for(list<string>::iterator it = hashTable[i].begin(); 
-          it != hashTable[i].end(); ++it)
-      {
-         fileObj << *it << ", ";
-      }
-      fileObj << endl;
-   }
+   writeTable(fileObj);
    fileObj.close();
 }
 
@@ -161,7 +238,7 @@ void Hash::output(string filename)
  * Desc: Printing the statistics of hashtable after implementation.
  *       Print total number of collisions, longest list ever generated,
  *       average list length over time(using curentAverage list length,
- *       Load factor of the hash table after entire implementation.   
+ *       Load factor of the hash table after entire implementation.
  *
  * In:   None. Uses memeber variables and functions
  * Out:  Prints four statistics
@@ -174,67 +251,365 @@ void Hash::printStats()
    cout << "Average List Length Over Time = " << avgLength << endl;
    cout << "Load Factor = " << loadFactor() << endl;
 }
-            
+
 /**
  * Desc: The function calculates the longest list ever generated. This is
  *       always incremented never decremented.
  *
- * In:   None. Uses the HASH_TABLE_SIZE    
+ * In:   None. Uses the buckets of both tables
  * Out:  unsigned int - Returns the longestlist which has unsigned int type
  */
-         
+
 unsigned int Hash::longList()
 {
-   longestList = hashTable[0].size();
-   for(int i = 0; i < HASH_TABLE_SIZE; i++)
+   for(size_t i = 0; i < table.capacity; i++)
+   {
+      if(table.bucketSize[i] >= longestList)
+         longestList = table.bucketSize[i];
+   }
+   for(size_t i = 0; i < old.capacity; i++)
    {
-      if(hashTable[i].size() >= longestList)
-         longestList = hashTable[i].size();
+      if(old.bucketSize[i] >= longestList)
+         longestList = old.bucketSize[i];
    }
    return longestList;
 }
 
 /**
  * Desc: This function returns the average List Length over the time.
- *       It is calculated(Called) after every insert and remove.
+ *       It is calculated(Called) after every insert and remove, from the
+ *       number of words and of nonempty buckets which are kept up to date.
+ *       While the table grows a bucket not moved yet counts as one.
  *
- * In:   No input.Uses the HASH_TABLE_SIZE which is a member variable 
- *       which can be changed dynamically.
+ * In:   No input.
  * Out:  Calcualtes the current average length average length over time.
  *
  */
-         
+
 void Hash::averageLength()
 {
-   double nonEmpty = 0.0;
-   double totalItems = 0.0;
-   for(int i = 0;i < HASH_TABLE_SIZE; i++)
-   {
-      totalItems = totalItems + (hashTable[i].size());
-      if(!hashTable[i].empty())
-         nonEmpty = nonEmpty + 1.0;
-   }  
-   currentAvgListLen = totalItems / nonEmpty;
+   currentAvgListLen = (double)(table.used + old.used)
+                       / (double)(table.nonEmpty + old.nonEmpty);
    avgLength = (currentAvgListLen + avgLength) / 2.0;
 }
-            
+
 /**
  *  Desc: This function calculates the load factor of the hash table.
- *        It is calculated by no. of elements in the table/ no. of slots 
+ *        It is calculated by no. of elements in the table/ no. of slots
  *        or no. of linked list( Some may be empty)
  *
- *  In:   None. Uses HASH_TABLE_SIZE.
+ *  In:   None. Uses the capacity of the table.
  *  Out:  double- returns the double loadFactor
  */
 
 double Hash::loadFactor()
-{  
-   double loadFact = 0.0;
-   double totalItems = 0.0;
-   for(int i = 0;i < HASH_TABLE_SIZE; i++)
+{
+   return (double)(table.used + old.used) / table.capacity;
+}
+
+/**
+ * Desc: The bucket of a hash in a table of a capacity. The bucket of a table
+ *       twice as large is the same one or the one a capacity above it.
+ *
+ */
+
+size_t Hash::bucketOf(unsigned int hash, size_t capacity)
+{
+   return (mix(hash) >> 7) & (capacity - 1);
+}
+
+/**
+ * Desc: Looks a word up. The probe starts at the group given by its hash
+ *       and moves on by growing steps until a group with an empty slot
+ *       ends it. Only slots whose control byte holds the word's 7 hash
+ *       bits and whose stored hash equals its hash have their word
+ *       compared.
+ *
+ * In:   Table - where to look, string - the word, unsigned int - its hashOf
+ * Out:  size_t - its slot, NONE when it is not in the table
+ */
+
+size_t Hash::find(Table& t, const string& word, unsigned int hash)
+{
+   uint32_t mixed = mix(hash);
+   signed char tag = (signed char)(mixed & 0x7F);
+   size_t mask = t.capacity - 1;
+   size_t pos = (mixed >> 7) & mask;
+   for(size_t step = GROUP; ; step += GROUP)
    {
-      totalItems = totalItems + hashTable[i].size();
+      uint64_t group = loadGroup(&t.control[pos]);
+      for(uint64_t match = matchTag(group, tag); match != 0;
+          match &= match - 1)
+      {
+         size_t slot = (pos + lowest(match)) & mask;
+         const Entry& entry = t.entries[slot];
+         if(t.control[slot] == tag && entry.hash == hash
+            && entry.length == word.length()
+            && memcmp(arena.data() + entry.offset, word.data(),
+                      entry.length) == 0)
+            return slot;
+      }
+      if(matchEmpty(group) != 0)
+         return NONE;
+      pos = (pos + step) & mask;
+   }
+}
+
+/**
+ * Desc: Appends a word to the arena and gives it a slot. A full table
+ *       starts to grow first. While it grows the word's bucket is moved
+ *       out of the old table, so that the size of its bucket is right,
+ *       and MIGRATE more buckets with it. The old table is empty before
+ *       the new one can fill up: it holds at most a max load factor of
+ *       words and is gone after capacity / MIGRATE inserts.
+ *
+ *       Slots hold 32 bit arena offsets, so a word which would end past
+ *       4 GiB of arena is refused with length_error, the table unchanged.
+ *
+ * In:   string - the word, copies are allowed, unsigned int - its hashOf
+ * Out:  unsigned int - the number of words in its bucket, itself included
+ */
+
+unsigned int Hash::insert(const string& word, unsigned int hash)
+{
+   if(word.length() > UINT32_MAX - arena.size())
+      throw std::length_error("Hash: words exceed 4 GiB");
+   if(table.growthLeft == 0)
+      grow();
+   if(old.capacity != 0)
+   {
+      drain(bucketOf(hash, old.capacity));
+      migrate(MIGRATE);
+   }
+   Entry entry;
+   entry.hash = hash;
+   entry.offset = (uint32_t)arena.size();
+   entry.length = (uint32_t)word.length();
+   arena.insert(arena.end(), word.begin(), word.end());
+   return place(table, entry);
+}
+
+/**
+ * Desc: Puts an entry into the first empty or deleted slot on the probe
+ *       path of its hash. The table must have growth left.
+ *
+ * Out:  unsigned int - the number of words in its bucket now
+ */
+
+unsigned int Hash::place(Table& t, const Entry& entry)
+{
+   uint32_t mixed = mix(entry.hash);
+   size_t mask = t.capacity - 1;
+   size_t bucket = (mixed >> 7) & mask;
+   size_t pos = bucket;
+   for(size_t step = GROUP; ; step += GROUP)
+   {
+      uint64_t open = matchEmptyOrDeleted(loadGroup(&t.control[pos]));
+      if(open != 0)
+      {
+         size_t slot = (pos + lowest(open)) & mask;
+         if(t.control[slot] == EMPTY)
+            t.growthLeft--;
+         setControl(t, slot, (signed char)(mixed & 0x7F));
+         t.entries[slot] = entry;
+         t.used++;
+         if(t.bucketSize[bucket]++ == 0)
+            t.nonEmpty++;
+         return t.bucketSize[bucket];
+      }
+      pos = (pos + step) & mask;
+   }
+}
+
+/**
+ * Desc: Marks a slot deleted, so probes for other words still pass it.
+ *
+ */
+
+void Hash::erase(Table& t, size_t slot)
+{
+   setControl(t, slot, DELETED);
+   t.used--;
+   size_t bucket = bucketOf(t.entries[slot].hash, t.capacity);
+   if(--t.bucketSize[bucket] == 0)
+      t.nonEmpty--;
+}
+
+/**
+ * Desc: Makes the full table the old one and starts an empty one to move
+ *       its words into, twice as large unless deleted slots made up most
+ *       of the full one. A move still in progress is finished first.
+ *
+ */
+
+void Hash::grow()
+{
+   migrate(old.capacity);
+   size_t capacity = table.capacity;
+   if(table.used > limit(capacity) / 2)
+      capacity *= 2;
+   old = std::move(table);
+   reset(table, capacity);
+   cursor = 0;
+}
+
+/**
+ * Desc: Moves the next buckets of the old table into the table and lets
+ *       the old table go once all of them are moved.
+ *
+ * In:   size_t - the number of buckets to move
+ */
+
+void Hash::migrate(size_t buckets)
+{
+   for(; buckets > 0 && cursor < old.capacity; buckets--)
+      drain(cursor++);
+   if(cursor == old.capacity)
+      old = Table();
+}
+
+/**
+ * Desc: Moves every word of a bucket of the old table into the table. They
+ *       all sit on the probe path of the bucket before its first group
+ *       with an empty slot. A bucket moved before has none left to move.
+ *
+ * In:   size_t - the bucket in the old table
+ */
+
+void Hash::drain(size_t bucket)
+{
+   size_t mask = old.capacity - 1;
+   size_t pos = bucket;
+   for(size_t step = GROUP; ; step += GROUP)
+   {
+      uint64_t group = loadGroup(&old.control[pos]);
+      for(uint64_t full = ~group & MSBS; full != 0; full &= full - 1)
+      {
+         size_t slot = (pos + lowest(full)) & mask;
+         if(bucketOf(old.entries[slot].hash, old.capacity) == bucket)
+         {
+            place(table, old.entries[slot]);
+            erase(old, slot);
+         }
+      }
+      if(matchEmpty(group) != 0)
+         return;
+      pos = (pos + step) & mask;
+   }
+}
+
+/**
+ * Desc: Rebuilds the table at its capacity, after finishing any move. The
+ *       words are placed again in the order they came in, by their stored
+ *       hashes, and copied into a fresh arena, which drops the deleted
+ *       slots and the bytes of removed words.
+ *
+ */
+
+void Hash::compact()
+{
+   migrate(old.capacity);
+   vector<Entry> live;
+   live.reserve(table.used);
+   for(size_t slot = 0; slot < table.capacity; slot++)
+   {
+      if(table.control[slot] >= 0)
+         live.push_back(table.entries[slot]);
+   }
+   sort(live.begin(), live.end(),
+        [](const Entry& a, const Entry& b) { return a.offset < b.offset; });
+   vector<char> bytes;
+   bytes.swap(arena);
+   arena.reserve(bytes.size() - deadBytes);
+   reset(table, table.capacity);
+   deadBytes = 0;
+   for(size_t i = 0; i < live.size(); i++)
+   {
+      Entry entry = live[i];
+      entry.offset = (uint32_t)arena.size();
+      arena.insert(arena.end(), bytes.data() + live[i].offset,
+                   bytes.data() + live[i].offset + live[i].length);
+      place(table, entry);
+   }
+}
+
+/**
+ * Desc: Makes a table an empty one of a capacity. The slots and bucket
+ *       sizes come from calloc, which for a large table maps pages that
+ *       are zero already, so their cost is paid as inserts first touch
+ *       them rather than all at once here.
+ *
+ * In:   Table - the table, size_t - its capacity, a power of two of at
+ *       least GROUP
+ */
+
+void Hash::reset(Table& t, size_t capacity)
+{
+   t.capacity = capacity;
+   t.control.assign(capacity + GROUP - 1, EMPTY);
+   t.entries.reset((Entry*)calloc(capacity, sizeof(Entry)));
+   t.bucketSize.reset((unsigned int*)calloc(capacity, sizeof(unsigned int)));
+   if(!t.entries || !t.bucketSize)
+      throw std::bad_alloc();
+   t.used = 0;
+   t.growthLeft = limit(capacity);
+   t.nonEmpty = 0;
+}
+
+/**
+ * Desc: The most words a capacity holds at the max load factor, one at
+ *       least.
+ *
+ */
+
+size_t Hash::limit(size_t capacity)
+{
+   size_t most = (size_t)(capacity * maxLoad);
+   return most == 0 ? 1 : most;
+}
+
+/**
+ * Desc: Sets the control byte of a slot. The first GROUP - 1 bytes are
+ *       mirrored behind the last slot, so a group read near the end wraps
+ *       around to the start without a second load.
+ *
+ */
+
+void Hash::setControl(Table& t, size_t slot, signed char value)
+{
+   t.control[slot] = value;
+   if(slot < GROUP - 1)
+      t.control[t.capacity + slot] = value;
+}
+
+/**
+ * Desc: Writes every bucket with its words in the order they were added,
+ *       the format of print and output. A move in progress is finished
+ *       first.
+ *
+ * In:   ostream - where to write
+ */
+
+void Hash::writeTable(std::ostream& out)
+{
+   migrate(old.capacity);
+   vector<vector<Entry> > lists(table.capacity);
+   for(size_t slot = 0; slot < table.capacity; slot++)
+   {
+      if(table.control[slot] >= 0)
+         lists[bucketOf(table.entries[slot].hash, table.capacity)]
+            .push_back(table.entries[slot]);
+   }
+   for(size_t i = 0;i < table.capacity;i++)
+   {
+      sort(lists[i].begin(), lists[i].end(),
+           [](const Entry& a, const Entry& b) { return a.offset < b.offset; });
+      out << i << ":\t";
+      for(size_t w = 0; w < lists[i].size(); w++)
+      {
+         out.write(arena.data() + lists[i][w].offset, lists[i][w].length);
+         out << ", ";
+      }
+      out << endl;
    }
-   loadFact = totalItems / HASH_TABLE_SIZE;
-   return loadFact;
 }
@@ -1,19 +1,29 @@
-/* This assignment originated at UC Riverside. The hash table size
- should be defined at compile time. Use -D HASH_TABLE_SIZE=X */
- 
+/* This assignment originated at UC Riverside. The hash table size is
+ given to the constructor and grows at run time. -D HASH_TABLE_SIZE=X
+ still sets the size the default constructor starts with. */
+
 #ifndef __HASH_H
 #define __HASH_H
 
 #include <string>
-#include <list>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <stdint.h>
+
+#ifndef HASH_TABLE_SIZE
+#define HASH_TABLE_SIZE 16
+#endif
 
 using std::string;
-using std::list;
+using std::vector;
 
 class Hash {
 
 public:
-   Hash();                          // constructor
+   Hash(size_t = HASH_TABLE_SIZE, double = 0.875); // buckets, max load
    void remove(string);             // remove key from hash table
    void print();                    // print the entire hash table
    void processFile(string);        // open file and add keys to hash table
@@ -22,20 +32,70 @@ public:
    void printStats();               // print statistics
 
 private:
-   // HASH_TABLE_SIZE should be defined using the -D option for g++
-   list<string> hashTable [HASH_TABLE_SIZE];
+   // The buckets are the slots of an open addressing table, a word's
+   // bucket is the slot its probe starts at. There are a power of two of
+   // them, doubled whenever the words would exceed the max load factor.
    int collisions;                  // total number of collisions
    unsigned int longestList;        // longest list ever generated
    double avgLength;                // running average of average list length
 
-   int hf(string);                  // the hash function
+   unsigned int hashOf(const char*,size_t); // the hash function
 
 // put additional functions below as needed
-// do not change anything above!
+   class Entry                      // Where the word of a slot is in arena
+   {
+   public:
+      unsigned int hash;            // hashOf the word
+      uint32_t offset;              // First byte of the word
+      uint32_t length;              // Bytes of the word
+   };
+
+   class Free                       // Gives back what calloc gave
+   {
+   public:
+      void operator()(void* block) const { std::free(block); }
+   };
+
+   class Table                      // The slots, of the table or of the
+   {                                // one being moved out of
+   public:
+      vector<signed char> control;  // Per slot: empty, deleted or 7 hash bits
+      std::unique_ptr<Entry[],Free> entries; // Per slot: the word, when full
+      std::unique_ptr<unsigned int[],Free> bucketSize; // Per bucket: words
+      size_t capacity;              // Number of slots, a power of two
+      size_t used;                  // Full slots
+      size_t growthLeft;            // Inserts into empty slots before growing
+      unsigned int nonEmpty;        // Buckets holding at least one word
+   };
+
+   static const size_t GROUP = 8;   // Control bytes matched at once
+   static const size_t MIGRATE = 16; // Old buckets moved on every insert
+   static const size_t NONE = (size_t)-1;
+
+   static size_t bucketOf(unsigned int,size_t); // Bucket of a hash
+   size_t find(Table&,const string&,unsigned int); // Slot, NONE if absent
+   unsigned int insert(const string&,unsigned int); // Size of its bucket
+   unsigned int place(Table&,const Entry&); // Puts an entry in a free slot
+   void erase(Table&,size_t);       // Frees the slot of a word
+   void grow();                     // Starts moving into a new table
+   void migrate(size_t);            // Moves some buckets of the old table
+   void drain(size_t);              // Moves one bucket of the old table
+   void compact();                  // Rebuilds the table and the arena
+   void reset(Table&,size_t);       // Empties a table at a capacity
+   size_t limit(size_t);            // Words a capacity may hold
+   static void setControl(Table&,size_t,signed char); // And its mirror
+   void writeTable(std::ostream&);  // Buckets and their words, in order
    unsigned int longList();        // calculates longest list ever generated
    double loadFactor();            // calculates load factor at the end
    void averageLength();           // average length over time is calculated
    double currentAvgListLen;       // mainatins current avg list lengths
+
+   Table table;                     // Where words are inserted
+   Table old;                       // Being moved into table, else empty
+   size_t cursor;                   // Next bucket of old to move
+   double maxLoad;                  // Most words per slot before growing
+   vector<char> arena;              // The words back to back, in insert order
+   size_t deadBytes;                // Arena bytes of removed words
 };
 
 #endif
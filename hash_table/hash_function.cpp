@@ -16,11 +16,11 @@
  *       This gave the best results as the longest list  ever was 2 & average 
  *       list length was 1.33.
  * 
- * @hashfunction: My hf uses two special prime number and its XOR with 
+ * @hashfunction: My hashOf uses two special prime number and its XOR with
  *                ASCII values of each letter of the string(XOR uses binary 
  *                numbers and then calculated).Secondly, multply by
- *                33. Finally HASH_TABLE_SIZE is used to map the hash within
- *                size of HashTable used.             
+ *                33. The full hash is returned, the HashTable mixes its
+ *                bits and maps it to a bucket itself (Hash::bucketOf).
  *
  * Reference: http://www.isthe.com/chongo/tech/comp/fnv/#FNV-1
  *            http://create.stephan-brumme.com/fnv-hash/
@@ -32,18 +32,18 @@
 using std::string;
 
 /*
- * Desc: Hash_function described above is implemented here.
- * In:   string- The string whose index is to calculated to place it in 
- *       hashtable.
- * Out:  returns integer- the index calculated by hash_function is returned.
+ * Desc: Hash_function described above is implemented here. The open
+ *       addressing table takes its buckets and control bytes from it.
+ * In:   const char* - the bytes of the string, size_t - their number
+ * Out:  returns unsigned int- the full hash.
  */
 
-int Hash::hf (string ins)
+unsigned int Hash::hashOf (const char* ins, size_t length)
 {
    unsigned int hash = 13;
-   for(int i = 0; i < (int)ins.length(); i++)
+   for(size_t i = 0; i < length; i++)
    {
       hash = (hash ^ ins[i]) * 33;
    }
-   return (hash % HASH_TABLE_SIZE);
+   return hash;
 }
@@ -0,0 +1,86 @@
+/**
+ *  @file: hashbench.cpp
+ *  @desc: Times Hash::search on sgb-words.txt. The words are loaded with
+ *         processFile, then every word is looked up a number of times,
+ *         once as it is and once with its first letter in upper case, which
+ *         is never in the file, so hits and misses of the same lengths are
+ *         timed separately. Prints the statistics of the table and the mean
+ *         ns per lookup of hits and of misses.
+ *
+ *         g++ -std=c++11 -O2 hashbench.cpp hash.cpp hash_function.cpp
+ *             -o hashbench
+ *         ./hashbench [words file] [rounds] [max load factor]
+ *
+ *  @author Diney Wankhede on 3/17/15
+ *
+ */
+
+#include "hash.h"
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ifstream;
+
+/**
+ * Desc: Searches for every word rounds times.
+ *
+ * In:   Hash, words, rounds, found - set to the number of hits
+ * Out:  double - mean ns per lookup
+ */
+
+static double timeSearch(Hash& table, const vector<string>& words,
+                         int rounds, size_t& found)
+{
+   std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+   found = 0;
+   for(int r = 0; r < rounds; r++)
+      for(size_t i = 0; i < words.size(); i++)
+         if(table.search(words[i]))
+            found++;
+   double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+   return ns / ((double)rounds * words.size());
+}
+
+int main(int argc, char* argv[])
+{
+   string file = argc > 1 ? argv[1] : "sgb-words.txt";
+   int rounds = argc > 2 ? atoi(argv[2]) : 20;
+   double load = argc > 3 ? atof(argv[3]) : 0.875;
+
+   ifstream in(file.c_str());
+   if(!in)
+   {
+      cerr << "cannot open " << file << endl;
+      return 1;
+   }
+   vector<string> hits;
+   vector<string> misses;
+   string word;
+   while(in >> word)
+   {
+      hits.push_back(word);
+      word[0] = (char)toupper((unsigned char)word[0]);
+      misses.push_back(word);
+   }
+
+   Hash table(HASH_TABLE_SIZE, load);
+   table.processFile(file);
+   table.printStats();
+
+   size_t found = 0;
+   double hitNs = timeSearch(table, hits, rounds, found);
+   cout << "hits: " << found << " of " << hits.size() * rounds << ", "
+        << hitNs << " ns/lookup" << endl;
+   double missNs = timeSearch(table, misses, rounds, found);
+   cout << "misses: " << found << " of " << misses.size() * rounds
+        << " found, " << missNs << " ns/lookup" << endl;
+   return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ *  @file: alignedallocator.h
+ *  @desc: Allocator for std::vector which places element Offset/sizeof(T)
+ *         on an Align byte boundary. MinPriorityQ uses it so that every
+ *         group of children of its d-ary heap starts a cache line.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____alignedallocator__
+#define ____alignedallocator__
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+template <typename T, size_t Align, size_t Offset = 0>
+class AlignedAllocator
+{
+public:
+   typedef T value_type;
+   template <typename U>
+   struct rebind
+   {
+      typedef AlignedAllocator<U,Align,Offset> other;
+   };
+
+   AlignedAllocator();                                  //Constructor
+   template <typename U>                                //Rebound copy
+   AlignedAllocator(const AlignedAllocator<U,Align,Offset>&);
+
+   T* allocate(size_t n);                               //Aligned storage
+   void deallocate(T* p, size_t n);                     //Frees storage
+};
+
+/**
+ * Desc: Constructors, the allocator has no state.
+ *
+ */
+
+template <typename T, size_t Align, size_t Offset>
+AlignedAllocator<T,Align,Offset>::AlignedAllocator()
+{
+
+}
+
+template <typename T, size_t Align, size_t Offset>
+template <typename U>
+AlignedAllocator<T,Align,Offset>::AlignedAllocator(
+   const AlignedAllocator<U,Align,Offset>&)
+{
+
+}
+
+/**
+ * Desc: Allocates room for n elements so that (address + Offset) is a
+ *       multiple of Align. The pointer malloc returned is kept just in
+ *       front of the storage for deallocate.
+ *
+ * In:   size_t - number of elements
+ * Out:  T* - the storage, throws bad_alloc when memory is out
+ */
+
+template <typename T, size_t Align, size_t Offset>
+T* AlignedAllocator<T,Align,Offset>::allocate(size_t n)
+{
+   char* raw = (char*)malloc(n * sizeof(T) + Align + Offset + sizeof(void*));
+   if (raw == NULL)
+      throw std::bad_alloc();
+   size_t start = (size_t)(raw + sizeof(void*) + Offset);
+   start = (start + Align - 1) / Align * Align - Offset;
+   memcpy((char*)start - sizeof(void*), &raw, sizeof(void*));
+   return (T*)start;
+}
+
+/**
+ * Desc: Frees storage handed out by allocate.
+ *
+ */
+
+template <typename T, size_t Align, size_t Offset>
+void AlignedAllocator<T,Align,Offset>::deallocate(T* p, size_t)
+{
+   char* raw;
+   memcpy(&raw, (char*)p - sizeof(void*), sizeof(void*));
+   free(raw);
+}
+
+template <typename T, typename U, size_t Align, size_t Offset>
+bool operator==(const AlignedAllocator<T,Align,Offset>&,
+                const AlignedAllocator<U,Align,Offset>&)
+{
+   return true;
+}
+
+template <typename T, typename U, size_t Align, size_t Offset>
+bool operator!=(const AlignedAllocator<T,Align,Offset>&,
+                const AlignedAllocator<U,Align,Offset>&)
+{
+   return false;
+}
+
+#endif /* defined(____alignedallocator__) */
@@ -0,0 +1,252 @@
+/**
+ *  @file: bucketqueue.h
+ *  @desc: BucketQueue, a lock-free bounded min priority queue for integer
+ *         keys in [0, keys). Every key has a bucket, a lock-free stack of
+ *         nodes, and a hint remembers the lowest bucket which may hold an
+ *         element. No operation ever takes a lock, so a producer is never
+ *         held up by a consumer which was preempted halfway.
+ *
+ *         Nodes come from a pool of fixed capacity and go back to it after
+ *         extraction, insert reports false when the pool is used up. Stack
+ *         heads and the hint carry a version next to the index, which keeps
+ *         a compare and swap from succeeding on a head that was popped and
+ *         pushed again in between (the ABA problem). Because nodes are
+ *         never freed while the queue lives, a thread may still read a
+ *         node that was popped under it.
+ *
+ *         extractMin returns an element of the lowest bucket it finds
+ *         filled. Elements of equal key leave in no particular order.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____bucketqueue__
+#define ____bucketqueue__
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+template <typename Id>
+class BucketQueue
+{
+public:
+   BucketQueue(size_t keys, size_t capacity); //Keys in [0, keys)
+   ~BucketQueue();              //Destructor
+
+   bool insert(Id,size_t);      //Adds an element, false when full
+   bool extractMin(Id&);        //Removes a minimum, false when empty
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements, exact when quiescent
+
+private:
+   class Node
+   {
+   public:
+      Id id;
+      std::atomic<uint32_t> next;  //Next node of the stack, NIL at the end
+   };
+
+   static const uint32_t NIL = 0xFFFFFFFFu;
+
+   static uint64_t pack(uint32_t,uint32_t);    //Version and index
+   static uint32_t index(uint64_t);            //Index of a packed value
+   void push(std::atomic<uint64_t>&,uint32_t); //Pushes a node on a stack
+   uint32_t pop(std::atomic<uint64_t>&);       //Pops a node, NIL if empty
+   void lowerHint(size_t);                     //Hint to at most a bucket
+
+   Node* nodes;                 //Pool of capacity nodes
+   std::vector<std::atomic<uint64_t> > buckets; //Stack head per key
+   std::atomic<uint64_t> freeNodes;            //Stack of unused nodes
+   std::atomic<uint64_t> hint;  //No bucket below it holds an element
+   std::atomic<size_t> elements;//Number of queued elements
+   BucketQueue(const BucketQueue&);            //Not copyable
+   BucketQueue& operator=(const BucketQueue&);
+};
+
+/**
+ * Desc: Constructor, every node starts on the free stack.
+ *
+ * In:   size_t - number of distinct keys, size_t - most elements queued
+ *
+ */
+
+template <typename Id>
+BucketQueue<Id>::BucketQueue(size_t keys, size_t capacity)
+   : nodes(new Node[capacity]), buckets(keys), freeNodes(pack(0, NIL)),
+     hint(pack(0, (uint32_t)keys)), elements(0)
+{
+   for (size_t k = 0; k < keys; k++)
+      buckets[k].store(pack(0, NIL));
+   for (size_t i = capacity; i-- > 0; )
+      push(freeNodes, (uint32_t)i);
+}
+
+/**
+ * Desc: Destructor, the queue must no longer be in use.
+ *
+ */
+
+template <typename Id>
+BucketQueue<Id>::~BucketQueue()
+{
+   delete[] nodes;
+}
+
+/**
+ * Desc: Takes a node from the pool, stores the element in it and pushes it
+ *       on the bucket of its key. Lock-free: a retry only happens when
+ *       another thread's operation succeeded.
+ *
+ * In:   Id - copied into the node, size_t - key, less than keys
+ * Out:  boolean - false when every node is in use, nothing is queued then
+ */
+
+template <typename Id>
+bool BucketQueue<Id>::insert(Id id, size_t key)
+{
+   uint32_t node = pop(freeNodes);
+   if (node == NIL)
+      return false;
+   nodes[node].id = id;
+   push(buckets[key], node);
+   elements.fetch_add(1, std::memory_order_relaxed);
+   lowerHint(key);
+   return true;
+}
+
+/**
+ * Desc: Pops a node of the lowest filled bucket at or above the hint. The
+ *       hint is raised past the empty buckets which were skipped, unless
+ *       an insert moved it meanwhile, since that insert may have filled one
+ *       of them.
+ *
+ * In:   Id& - gets the id of the removed element
+ * Out:  boolean - false when no bucket held an element
+ */
+
+template <typename Id>
+bool BucketQueue<Id>::extractMin(Id& id)
+{
+   uint64_t seen = hint.load(std::memory_order_acquire);
+   for (size_t k = index(seen); k < buckets.size(); k++)
+   {
+      uint32_t node = pop(buckets[k]);
+      if (node == NIL)
+         continue;
+      id = nodes[node].id;
+      push(freeNodes, node);
+      elements.fetch_sub(1, std::memory_order_relaxed);
+      if (k > index(seen))
+         hint.compare_exchange_strong(seen, pack((uint32_t)(seen >> 32) + 1,
+                                                 (uint32_t)k));
+      return true;
+   }
+   hint.compare_exchange_strong(seen, pack((uint32_t)(seen >> 32) + 1,
+                                           (uint32_t)buckets.size()));
+   return false;
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+template <typename Id>
+bool BucketQueue<Id>::empty() const
+{
+   return elements.load(std::memory_order_relaxed) == 0;
+}
+
+/**
+ * Desc: Number of elements in the queue. With other threads at work this
+ *       is only a snapshot.
+ *
+ */
+
+template <typename Id>
+size_t BucketQueue<Id>::size() const
+{
+   return elements.load(std::memory_order_relaxed);
+}
+
+/**
+ * Desc: Packs a version into the high and an index into the low 32 bits.
+ *
+ */
+
+template <typename Id>
+uint64_t BucketQueue<Id>::pack(uint32_t version, uint32_t at)
+{
+   return (uint64_t)version << 32 | at;
+}
+
+template <typename Id>
+uint32_t BucketQueue<Id>::index(uint64_t packed)
+{
+   return (uint32_t)packed;
+}
+
+/**
+ * Desc: Treiber push of a node the caller owns.
+ *
+ */
+
+template <typename Id>
+void BucketQueue<Id>::push(std::atomic<uint64_t>& head, uint32_t node)
+{
+   uint64_t old = head.load(std::memory_order_relaxed);
+   do
+      nodes[node].next.store(index(old), std::memory_order_relaxed);
+   while (!head.compare_exchange_weak(old, pack((uint32_t)(old >> 32) + 1,
+                                                node),
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed));
+}
+
+/**
+ * Desc: Treiber pop. The next index read from a node that another thread
+ *       popped meanwhile is stale, the version makes the swap fail then.
+ *
+ */
+
+template <typename Id>
+uint32_t BucketQueue<Id>::pop(std::atomic<uint64_t>& head)
+{
+   uint64_t old = head.load(std::memory_order_acquire);
+   while (index(old) != NIL)
+   {
+      uint32_t next = nodes[index(old)].next.load(std::memory_order_relaxed);
+      if (head.compare_exchange_weak(old, pack((uint32_t)(old >> 32) + 1,
+                                               next),
+                                     std::memory_order_acquire,
+                                     std::memory_order_acquire))
+         return index(old);
+   }
+   return NIL;
+}
+
+/**
+ * Desc: Moves the hint down to a bucket that was just filled. The version
+ *       is bumped even when the hint is already low enough, so that an
+ *       extract which skipped the bucket before the push cannot raise the
+ *       hint past it.
+ *
+ */
+
+template <typename Id>
+void BucketQueue<Id>::lowerHint(size_t key)
+{
+   uint64_t old = hint.load(std::memory_order_relaxed);
+   uint32_t at;
+   do
+      at = index(old) < key ? index(old) : (uint32_t)key;
+   while (!hint.compare_exchange_weak(old, pack((uint32_t)(old >> 32) + 1, at),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed));
+}
+
+#endif /* defined(____bucketqueue__) */
@@ -0,0 +1,440 @@
+/**
+ *  @file: externalq.h
+ *  @desc: ExternalQ, a min priority queue for more elements than fit into
+ *         memory. New elements go into an in-memory MinPriorityQ, and when
+ *         it holds spill elements it is written to disk as one sorted run.
+ *         extractMin takes the smaller of the in-memory minimum and the
+ *         smallest head of the runs, which are read back lazily through a
+ *         buffer each, a buffered multiway merge in the manner of Sanders'
+ *         sequence heaps. Runs have levels, a spilled run starts at level 0
+ *         and once fanIn runs share a level they are merged into one run of
+ *         the next level. Every element is thus rewritten only
+ *         log_fanIn(n / spill) times and at most fanIn - 1 runs per level
+ *         hold a file and a buffer.
+ *
+ *         Runs are written and read strictly in order, a buffer of records
+ *         at a time. Their files are unlinked right after creation, so
+ *         nothing is left behind when the queue or the program goes away.
+ *         Ids and keys are written as raw bytes and must be trivially
+ *         copyable, for example integer ids and timestamps. An I/O error
+ *         throws std::runtime_error.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____externalq__
+#define ____externalq__
+
+#include "minpriority.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+using std::string;
+using std::vector;
+
+template <typename Id, typename Key = int, typename Compare = std::less<Key> >
+class ExternalQ
+{
+public:
+   explicit ExternalQ(size_t spill = 1 << 20, const string& dir = "/tmp",
+                      size_t buffer = 1 << 12, size_t fanIn = 64);
+   ~ExternalQ();                //Destructor, closes the run files
+
+   void insert(Id,Key);         //Adds an element, spills when memory is full
+   Id extractMin();             //Removes the minimum, queue must not be empty
+   const Key& minKey() const;   //Key of the minimum, queue must not be empty
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements in memory and on disk
+   size_t runs() const;         //Number of runs on disk
+
+private:
+   class Record                 //One element as stored on disk
+   {
+   public:
+      Key key;
+      Id id;
+   };
+   typedef MinPriorityQ<uint32_t,Key,Compare> RunQueue;
+   class Run                    //A sorted file and its read buffer
+   {
+   public:
+      Run(FILE*,uint64_t,size_t);//Constructor, takes over the file
+      ~Run();                   //Closes the file
+      FILE* file;
+      uint64_t unread;          //Records still in the file
+      vector<Record> buffer;    //Records read but not taken
+      size_t next;              //First record of buffer not yet taken
+      size_t level;             //Number of merges behind the run
+      typename RunQueue::Handle head; //Entry of the run in heads
+   };
+
+   FILE* createRun();           //Opens an unlinked file in dir
+   void write(FILE*,const vector<Record>&); //Appends records to a run
+   void addRun(FILE*,uint64_t,size_t); //Rewinds a written run, adds it
+   bool refill(Run&);           //Reads the next buffer of a run
+   bool advance(Run&);          //Steps past the head, false when drained
+   Record takeRun();            //Takes the smallest run head
+   void spill();                //Writes the in-memory heap as a run
+   void mergeLevel(size_t);     //Merges the runs of a level into one
+
+   MinPriorityQ<Id,Key,Compare> fresh;      //Elements not yet spilled
+   RunQueue heads;              //Runs by the key of their head
+   vector<std::unique_ptr<Run> > active;    //Runs, NULL once drained
+   size_t spillSize;            //Elements held in memory before a spill
+   string directory;            //Where the run files go
+   size_t bufferSize;           //Records per read or write
+   size_t fanInLimit;           //Runs of a level before they are merged
+   size_t onDisk;               //Elements in the runs
+   size_t runCount;             //Runs not yet drained
+   Compare compare;             //Order of the keys
+   ExternalQ(const ExternalQ&);                //Not copyable
+   ExternalQ& operator=(const ExternalQ&);
+};
+
+/**
+ * Desc: Constructor.
+ *
+ * In:   size_t - elements kept in memory before they are spilled as a run
+ *       string - directory of the run files
+ *       size_t - records per read and write of a run
+ *       size_t - runs of a level before they are merged into one, at least 2
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+ExternalQ<Id,Key,Compare>::ExternalQ(size_t spill, const string& dir,
+                                     size_t buffer, size_t fanIn)
+   : spillSize(spill < 1 ? 1 : spill), directory(dir),
+     bufferSize(buffer < 1 ? 1 : buffer), fanInLimit(fanIn < 2 ? 2 : fanIn),
+     onDisk(0), runCount(0)
+{
+
+}
+
+/**
+ * Desc: Destructor, the run files are closed and thereby removed.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+ExternalQ<Id,Key,Compare>::~ExternalQ()
+{
+
+}
+
+template <typename Id, typename Key, typename Compare>
+ExternalQ<Id,Key,Compare>::Run::Run(FILE* new_file, uint64_t records,
+                                    size_t new_level)
+   : file(new_file), unread(records), next(0), level(new_level)
+{
+
+}
+
+template <typename Id, typename Key, typename Compare>
+ExternalQ<Id,Key,Compare>::Run::~Run()
+{
+   fclose(file);
+}
+
+/**
+ * Desc: Adds an element to the in-memory heap. When that reaches the spill
+ *       size it is written to disk as a new run.
+ *
+ * In:   Id - Id of the element, Key - its key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void ExternalQ<Id,Key,Compare>::insert(Id id, Key key)
+{
+   fresh.insert(id, key);
+   if (fresh.size() >= spillSize)
+      spill();
+}
+
+/**
+ * Desc: Removes the minimum, from memory or from the head of a run.
+ *
+ * In:   None - the queue must not be empty
+ * Out:  Id - id of the minimum
+ */
+
+template <typename Id, typename Key, typename Compare>
+Id ExternalQ<Id,Key,Compare>::extractMin()
+{
+   if (heads.empty()
+       || (!fresh.empty() && !compare(heads.minKey(), fresh.minKey())))
+      return fresh.extractMin();
+   return takeRun().id;
+}
+
+/**
+ * Desc: Key of the minimum without extracting it.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+const Key& ExternalQ<Id,Key,Compare>::minKey() const
+{
+   if (heads.empty()
+       || (!fresh.empty() && !compare(heads.minKey(), fresh.minKey())))
+      return fresh.minKey();
+   return heads.minKey();
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+bool ExternalQ<Id,Key,Compare>::empty() const
+{
+   return fresh.empty() && heads.empty();
+}
+
+/**
+ * Desc: Number of elements in memory and on disk.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+size_t ExternalQ<Id,Key,Compare>::size() const
+{
+   return fresh.size() + onDisk;
+}
+
+/**
+ * Desc: Number of runs on disk which still hold elements.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+size_t ExternalQ<Id,Key,Compare>::runs() const
+{
+   return runCount;
+}
+
+/**
+ * Desc: Creates a file for a run in the directory and unlinks it at once,
+ *       it lives on until it is closed.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+FILE* ExternalQ<Id,Key,Compare>::createRun()
+{
+   string path = directory + "/mpqrunXXXXXX";
+   vector<char> name(path.begin(), path.end());
+   name.push_back('\0');
+   int fd = mkstemp(&name[0]);
+   if (fd < 0)
+      throw std::runtime_error(path + ": " + strerror(errno));
+   unlink(&name[0]);
+   FILE* file = fdopen(fd, "w+b");
+   if (file == NULL)
+   {
+      close(fd);
+      throw std::runtime_error(path + ": " + strerror(errno));
+   }
+   return file;
+}
+
+/**
+ * Desc: Appends a batch of records to a run file.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void ExternalQ<Id,Key,Compare>::write(FILE* file, const vector<Record>& out)
+{
+   if (fwrite(&out[0], sizeof(Record), out.size(), file) != out.size())
+      throw std::runtime_error(string("writing a run: ") + strerror(errno));
+}
+
+/**
+ * Desc: Rewinds a run that was just written, reads its first buffer and
+ *       enters its head into heads. A drained slot of active is reused.
+ *
+ * In:   FILE* - the run, uint64_t - records in it, size_t - its level
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void ExternalQ<Id,Key,Compare>::addRun(FILE* file, uint64_t records,
+                                       size_t level)
+{
+   if (fflush(file) != 0 || fseek(file, 0, SEEK_SET) != 0)
+      throw std::runtime_error(string("rewinding a run: ") + strerror(errno));
+   size_t r = 0;
+   while (r < active.size() && active[r])
+      r++;
+   if (r == active.size())
+      active.push_back(NULL);
+   active[r].reset(new Run(file, records, level));
+   Run& run = *active[r];
+   refill(run);
+   run.head = heads.insert((uint32_t)r, run.buffer[0].key);
+   onDisk += records;
+   runCount++;
+}
+
+/**
+ * Desc: Reads the next buffer of records of a run.
+ *
+ * Out:  boolean - false when the file had no record left
+ */
+
+template <typename Id, typename Key, typename Compare>
+bool ExternalQ<Id,Key,Compare>::refill(Run& run)
+{
+   if (run.unread == 0)
+      return false;
+   size_t count = run.unread < bufferSize ? (size_t)run.unread : bufferSize;
+   run.buffer.resize(count);
+   if (fread(&run.buffer[0], sizeof(Record), count, run.file) != count)
+      throw std::runtime_error(string("reading a run: ") + strerror(errno));
+   run.unread -= count;
+   run.next = 0;
+   return true;
+}
+
+/**
+ * Desc: Steps past the head of a run, reading its next buffer when the
+ *       current one is used up.
+ *
+ * Out:  boolean - false when the run has no record left
+ */
+
+template <typename Id, typename Key, typename Compare>
+bool ExternalQ<Id,Key,Compare>::advance(Run& run)
+{
+   run.next++;
+   return run.next < run.buffer.size() || refill(run);
+}
+
+/**
+ * Desc: Takes the head of the run with the smallest head. The run's next
+ *       record becomes its head, a drained run is closed.
+ *
+ * Out:  Record - the taken element
+ */
+
+template <typename Id, typename Key, typename Compare>
+typename ExternalQ<Id,Key,Compare>::Record
+ExternalQ<Id,Key,Compare>::takeRun()
+{
+   uint32_t r = heads.extractMin();
+   Run& run = *active[r];
+   Record record = run.buffer[run.next];
+   onDisk--;
+   if (advance(run))
+      run.head = heads.insert(r, run.buffer[run.next].key);
+   else
+   {
+      active[r].reset();
+      runCount--;
+   }
+   return record;
+}
+
+/**
+ * Desc: Writes the in-memory heap to a new run of level 0 in sorted order.
+ *       A level holding fanIn runs is merged into the next, which may then
+ *       fill up in turn.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void ExternalQ<Id,Key,Compare>::spill()
+{
+   FILE* file = createRun();
+   uint64_t records = fresh.size();
+   vector<Record> out;
+   out.reserve(bufferSize);
+   while (!fresh.empty())
+   {
+      Record record;
+      record.key = fresh.minKey();
+      record.id = fresh.extractMin();
+      out.push_back(record);
+      if (out.size() == bufferSize || fresh.empty())
+      {
+         write(file, out);
+         out.clear();
+      }
+   }
+   addRun(file, records, 0);
+   for (size_t level = 0; ; level++)
+   {
+      size_t count = 0;
+      for (size_t r = 0; r < active.size(); r++)
+         count += active[r] && active[r]->level == level;
+      if (count < fanInLimit)
+         break;
+      mergeLevel(level);
+   }
+}
+
+/**
+ * Desc: Merges the runs of one level into a single run of the next level,
+ *       taking their heads in order through a queue of their own, so
+ *       reading and writing both stay sequential. The merged runs leave
+ *       heads and the new run takes their place.
+ *
+ * In:   size_t - the level
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void ExternalQ<Id,Key,Compare>::mergeLevel(size_t level)
+{
+   RunQueue merge;
+   uint64_t records = 0;
+   for (size_t r = 0; r < active.size(); r++)
+   {
+      if (!active[r] || active[r]->level != level)
+         continue;
+      Run& run = *active[r];
+      heads.erase(run.head);
+      merge.insert((uint32_t)r, run.buffer[run.next].key);
+      records += run.unread + (run.buffer.size() - run.next);
+   }
+
+   FILE* file = createRun();
+   vector<Record> out;
+   out.reserve(bufferSize);
+   while (!merge.empty())
+   {
+      uint32_t r = merge.extractMin();
+      Run& run = *active[r];
+      out.push_back(run.buffer[run.next]);
+      if (advance(run))
+         merge.insert(r, run.buffer[run.next].key);
+      else
+      {
+         active[r].reset();
+         runCount--;
+      }
+      if (out.size() == bufferSize || merge.empty())
+      {
+         write(file, out);
+         out.clear();
+      }
+   }
+   onDisk -= records;
+   addRun(file, records, level + 1);
+}
+
+#endif /* defined(____externalq__) */
@@ -3,34 +3,528 @@
  * @desc: Test driver using the minpriority.h for implementing minpriority 
  *        queue.
  *
+ *        Commands: a id key (add), d id key (decrease), i id key (increase),
+ *        u id key (update either way), e id (erase), l file (load "id key"
+ *        lines), x (extract and print), t k file (print the ids of the k
+ *        smallest keys of a file of "id key" lines, smallest first, the
+ *        queue is left alone), q (quit). The driver keeps the
+ *        handles of every id so d, i, u and e do not scan the queue. An id
+ *        may be added more than once, d, i, u and e then act on its oldest
+ *        element still queued.
+ *
+ *        ./minpq -f runs the same commands in fast mode for long replay
+ *        files: input is read in large blocks and parsed in place, runs
+ *        of consecutive adds go into the heap as one bulk build, and
+ *        output is collected and written in large blocks too.
+ *
+ *        ./minpq -r runs either mode on a RadixHeap instead of the binary
+ *        heap, for monotone workloads whose extracted keys never decrease.
+ *
+ *        Built with -DMPQ_METRICS the binary heap's counts and latencies
+ *        are printed to stderr when the input ends or on q.
+ *
  * @date: 04/22/2015
  * @author: Diney Wankhede
  *
  */
 
 #include "minpriority.h"
+#include "topk.h"
+#include "radixheap.h"
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <climits>
 
 using std::string;
 using std::cout;
 using std::cin;
 using std::stringstream;
 using std::endl;
+using std::cerr;
+using std::ifstream;
+using std::vector;
+using std::pair;
+using std::make_pair;
+using std::back_inserter;
+using std::unordered_map;
+
+template <typename Queue>
+using HandleMap = unordered_map<string,vector<typename Queue::Handle> >;
 
 /**
- * Desc: main function which is the test driver for the program. It processes 
- *       all commands, inputs and calls the desired function for maintaining
- *       minpriority queue.
- * In:   No input. Uses input from the user and processes it.
- * Out:  Returns 0 - Integer. Calls desired function as per input from user.
+ * Desc: RadixHeap behind the int keys of the driver, the -r option. A key
+ *       is mapped to uint64_t with its sign bit flipped, which keeps the
+ *       order of negative and positive keys. The radix heap is monotone:
+ *       a key added or set below the last extracted one is raised to it.
+ *
+ */
+
+class RadixQ
+{
+public:
+   typedef RadixHeap<string,uint64_t>::Handle Handle;
+
+   Handle insert(string,int);   //Adds an element
+   template <typename InputIt, typename OutputIt> //Adds (id, int) pairs
+   void bulkInsert(InputIt first, InputIt last, OutputIt handles);
+   void decreaseKey(Handle,int);//Lowers a key, a larger one is ignored
+   void increaseKey(Handle,int);//Raises a key, a smaller one is ignored
+   void updateKey(Handle,int);  //Sets a key, either direction
+   bool erase(Handle);          //Removes an element, false if it is gone
+   bool contains(Handle) const; //True while the element is queued
+   string extractMin();         //Removes the minimum
+   bool empty() const;          //True when no element is left
+
+private:
+   static uint64_t toKey(int);  //Order preserving map to uint64_t
+
+   RadixHeap<string,uint64_t> heap;
+};
+
+RadixQ::Handle RadixQ::insert(string id, int key)
+{
+   return heap.insert(std::move(id), toKey(key));
+}
+
+template <typename InputIt, typename OutputIt>
+void RadixQ::bulkInsert(InputIt first, InputIt last, OutputIt handles)
+{
+   for (; first != last; ++first, ++handles)
+      *handles = insert(first->first, first->second);
+}
+
+void RadixQ::decreaseKey(Handle handle, int key)
+{
+   heap.decreaseKey(handle, toKey(key));
+}
+
+void RadixQ::increaseKey(Handle handle, int key)
+{
+   heap.increaseKey(handle, toKey(key));
+}
+
+void RadixQ::updateKey(Handle handle, int key)
+{
+   heap.updateKey(handle, toKey(key));
+}
+
+bool RadixQ::erase(Handle handle)
+{
+   return heap.erase(handle);
+}
+
+bool RadixQ::contains(Handle handle) const
+{
+   return heap.contains(handle);
+}
+
+string RadixQ::extractMin()
+{
+   return heap.extractMin();
+}
+
+bool RadixQ::empty() const
+{
+   return heap.empty();
+}
+
+uint64_t RadixQ::toKey(int key)
+{
+   return (uint32_t)key ^ 0x80000000u;
+}
+
+/**
+ * Desc: Prints the metrics of the queue to stderr at the end of a run. Only
+ *       MinPriorityQ has them, and only when built with MPQ_METRICS.
+ *
+ */
+
+#ifdef MPQ_METRICS
+void reportMetrics(const MinPriorityQ<>& myMPQ)
+{
+   myMPQ.metrics().report(cerr);
+}
+#endif
+
+template <typename Queue>
+void reportMetrics(const Queue&)
+{
+
+}
+
+/**
+ * Desc: Adds a batch of (id, key) pairs with one bulk build and records
+ *       their handles. The batch is left empty.
+ *
+ * In:   vector - the pairs, Queue - the queue, HandleMap - handles
+ *
+ */
+
+template <typename Queue>
+void addAll(vector<pair<string,int> >& entries, Queue& myMPQ,
+            HandleMap<Queue>& handles)
+{
+   vector<typename Queue::Handle> added;
+   added.reserve(entries.size());
+   myMPQ.bulkInsert(entries.begin(), entries.end(), back_inserter(added));
+   for (size_t i = 0; i < entries.size(); i++)
+      handles[entries[i].first].push_back(added[i]);
+   entries.clear();
+}
+
+/**
+ * Desc: Handle of the oldest queued element of an id. Handles of elements
+ *       of the id which left the queue are dropped on the way, and so is
+ *       the id once none is left.
+ *
+ * In:   HandleMap - handles, Queue - the queue, string - the id
+ * Out:  Handle* - NULL when no element of the id is queued
+ */
+
+template <typename Queue>
+typename Queue::Handle* liveHandle(HandleMap<Queue>& handles,
+                                   const Queue& myMPQ, const string& id)
+{
+   typename HandleMap<Queue>::iterator it = handles.find(id);
+   if (it == handles.end())
+      return NULL;
+   vector<typename Queue::Handle>& list = it->second;
+   list.erase(std::remove_if(list.begin(), list.end(),
+                             [&myMPQ](const typename Queue::Handle& handle)
+                             { return !myMPQ.contains(handle); }),
+              list.end());
+   if (list.empty())
+   {
+      handles.erase(it);
+      return NULL;
+   }
+   return &list.front();
+}
+
+/**
+ * Desc: Loads a file of "id key" lines into the queue, the l command.
+ *
+ * In:   string - file name, Queue - the queue, HandleMap - handles
+ *
+ */
+
+template <typename Queue>
+void loadFile(const string& fileName, Queue& myMPQ, HandleMap<Queue>& handles)
+{
+   ifstream file(fileName.c_str());
+   if (!file)
+   {
+      cerr<< "cannot open " << fileName << endl;
+      return;
+   }
+   vector<pair<string,int> > entries;
+   string line, fileId;
+   int fileKey;
+   while (getline(file,line))
+   {
+      stringstream ss(line);
+      if (ss >> fileId >> fileKey)
+         entries.push_back(make_pair(fileId,fileKey));
+   }
+   addAll(entries, myMPQ, handles);
+}
+
+/**
+ * Desc: Streams a file of "id key" lines through a TopK, the t command.
+ *       Only k elements are held however long the file is.
  *
+ * In:   string - file name, int - k
+ * Out:  vector - ids of the k smallest keys, smallest first
  */
 
-int main()
+vector<string> topOfFile(const string& fileName, int k)
 {
-   MinPriorityQ myMPQ;
+   vector<string> ids;
+   ifstream file(fileName.c_str());
+   if (!file)
+   {
+      cerr<< "cannot open " << fileName << endl;
+      return ids;
+   }
+   TopK<string,int> best(k < 0 ? 0 : k);
+   string line, fileId;
+   int fileKey;
+   while (getline(file,line))
+   {
+      stringstream ss(line);
+      if (ss >> fileId >> fileKey)
+         best.offer(fileId,fileKey);
+   }
+   vector<pair<string,int> > sorted = best.extractSorted();
+   for (size_t i = 0; i < sorted.size(); i++)
+      ids.push_back(sorted[i].first);
+   return ids;
+}
+
+/**
+ * Desc: Driver of fast mode. Commands are parsed straight out of a block
+ *       buffer, with the same tokens and key rules as the line mode of
+ *       main, so both modes extract the same keys in the same order. A run
+ *       of adds goes through bulkInsert, which breaks ties differently from
+ *       one insert at a time, so the ids of equal keys may come out in a
+ *       different order.
+ *
+ */
+
+template <typename Queue>
+class FastDriver
+{
+public:
+   FastDriver();                //Constructor
+   void run();                  //Processes stdin up to its end or q
+
+private:
+   bool command(const char*,const char*);  //One line, false on q
+   void flushAdds();            //Queues the pending adds
+   void print(const string&);   //Adds a line to the output
+   void flushOutput();          //Writes the collected output
+
+   Queue myMPQ;
+   HandleMap<Queue> handles;    //Handles of every id, oldest first
+   vector<pair<string,int> > pending; //Consecutive adds not yet queued
+   string output;               //Output not yet written
+};
+
+/**
+ * Desc: Skips past the first space of [p, end), the way main erases up to
+ *       find(' ') + 1. Without a space nothing is skipped.
+ *
+ */
+
+const char* skipToken(const char* p, const char* end)
+{
+   const char* space = (const char*)memchr(p, ' ', end - p);
+   return space == NULL ? p : space + 1;
+}
+
+/**
+ * Desc: The token at p, up to the next space or the end of the line.
+ *
+ */
+
+string token(const char* p, const char* end)
+{
+   const char* space = (const char*)memchr(p, ' ', end - p);
+   return string(p, space == NULL ? end : space);
+}
+
+/**
+ * Desc: Parses a key like stringstream >> int: leading blanks, a sign and
+ *       at least one digit, anything after the digits is ignored. A value
+ *       out of the range of int fails.
+ *
+ * In:   const char* - start of the key token, const char* - end of line
+ *       int& - gets the key
+ * Out:  boolean - true when a key was read
+ */
+
+bool parseKey(const char* p, const char* end, int& key)
+{
+   while (p < end && (*p == '\t' || *p == '\r' || *p == '\v' || *p == '\f'))
+      p++;
+   bool negative = p < end && *p == '-';
+   if (p < end && (*p == '-' || *p == '+'))
+      p++;
+   if (p == end || *p < '0' || *p > '9')
+      return false;
+   long long value = 0;
+   for (; p < end && *p >= '0' && *p <= '9'; p++)
+   {
+      value = value * 10 + (*p - '0');
+      if (value > (long long)INT_MAX + 1)
+         return false;
+   }
+   if (negative)
+      value = -value;
+   if (value > INT_MAX || value < INT_MIN)
+      return false;
+   key = (int)value;
+   return true;
+}
+
+template <typename Queue>
+FastDriver<Queue>::FastDriver()
+{
+
+}
+
+/**
+ * Desc: Reads stdin in 1 MB blocks and hands every complete line to
+ *       command. An unfinished line at the end of a block is moved to the
+ *       front and completed by the next read.
+ *
+ */
+
+template <typename Queue>
+void FastDriver<Queue>::run()
+{
+   vector<char> block(1 << 20);
+   size_t kept = 0;                     //Bytes of an unfinished line
+   bool more = true;
+   while (more)
+   {
+      size_t got = fread(&block[kept], 1, block.size() - kept, stdin);
+      size_t filled = kept + got;
+      bool last = got == 0;
+      size_t start = 0;
+      while (more && start < filled)
+      {
+         const char* line = &block[start];
+         const char* newline = (const char*)memchr(line, '\n', filled - start);
+         if (newline == NULL && !last)
+            break;
+         const char* end = newline == NULL ? &block[0] + filled : newline;
+         more = command(line, end);
+         start = end - &block[0] + 1;
+      }
+      if (last)
+         break;
+      kept = start < filled ? filled - start : 0;
+      memmove(&block[0], &block[0] + start, kept);
+      if (kept == block.size())          //A line longer than the block
+         block.resize(2 * block.size());
+   }
+   flushAdds();
+   flushOutput();
+   reportMetrics(myMPQ);
+}
+
+/**
+ * Desc: Carries out one command. Adds are collected, any other command
+ *       first queues them so that it sees the same queue as in line mode.
+ *
+ * In:   const char* - start of the line, const char* - its end
+ * Out:  boolean - false when the command was q
+ */
+
+template <typename Queue>
+bool FastDriver<Queue>::command(const char* line, const char* end)
+{
+   const char* space = (const char*)memchr(line, ' ', end - line);
+   size_t length = (space == NULL ? end : space) - line;
+   if (length != 1)
+      return true;
+   char type = line[0];
+   const char* idAt = skipToken(line, end);
+   const char* keyAt = skipToken(idAt, end);
+   int key;
+   if (type == 'a')
+   {
+      string id = token(idAt, end);
+      if (!id.empty() && parseKey(keyAt, end, key))
+         pending.push_back(make_pair(id, key));
+      return true;
+   }
+   flushAdds();
+   if (type == 'd' || type == 'i' || type == 'u')
+   {
+      if (!parseKey(keyAt, end, key))
+         return true;
+      typename Queue::Handle* handle = liveHandle(handles, myMPQ,
+                                                  token(idAt, end));
+      if (handle == NULL)
+         return true;
+      if (type == 'd')
+         myMPQ.decreaseKey(*handle, key);
+      else if (type == 'i')
+         myMPQ.increaseKey(*handle, key);
+      else
+         myMPQ.updateKey(*handle, key);
+   }
+   else if (type == 'e')
+   {
+      string id = token(idAt, end);
+      typename Queue::Handle* handle = liveHandle(handles, myMPQ, id);
+      if (handle != NULL)
+      {
+         myMPQ.erase(*handle);
+         liveHandle(handles, myMPQ, id);   //Drops the erased handle
+      }
+   }
+   else if (type == 'l')
+   {
+      flushOutput();                   //Keeps the order with cerr
+      loadFile(token(idAt, end), myMPQ, handles);
+   }
+   else if (type == 't' && parseKey(idAt, end, key))
+   {
+      flushOutput();
+      vector<string> ids = topOfFile(token(keyAt, end), key);
+      for (size_t i = 0; i < ids.size(); i++)
+         print(ids[i]);
+   }
+   else if (type == 'x')
+   {
+      if (myMPQ.empty())
+         print("empty");
+      else
+      {
+         string id = myMPQ.extractMin();
+         liveHandle(handles, myMPQ, id);      //Drops the extracted handle
+         print(id);
+      }
+   }
+   return type != 'q';
+}
+
+/**
+ * Desc: Queues the collected adds with one bulk build.
+ *
+ */
+
+template <typename Queue>
+void FastDriver<Queue>::flushAdds()
+{
+   if (!pending.empty())
+      addAll(pending, myMPQ, handles);
+}
+
+/**
+ * Desc: Adds a line to the output, which is written once it passes 64 kB.
+ *
+ */
+
+template <typename Queue>
+void FastDriver<Queue>::print(const string& line)
+{
+   output += line;
+   output += '\n';
+   if (output.size() >= (1 << 16))
+      flushOutput();
+}
+
+template <typename Queue>
+void FastDriver<Queue>::flushOutput()
+{
+   fwrite(output.data(), 1, output.size(), stdout);
+   fflush(stdout);
+   output.clear();
+}
+
+/**
+ * Desc: Line mode, reads stdin one command per line.
+ *
+ */
+
+template <typename Queue>
+void runLines()
+{
+   Queue myMPQ;
+   HandleMap<Queue> handles;            //Handles of every id, oldest first
    string input, command, inputId, inputKeyString;
    int inputKey;
    while(!cin.eof())
@@ -49,11 +543,11 @@ int main()
          if (stringstream(inputKeyString) >> inputKey)
          {  
             if(!inputId.empty())
-               myMPQ.insert(inputId,inputKey);
+               handles[inputId].push_back(myMPQ.insert(inputId,inputKey));
          }
       }
-      else if (command == "d")          //Updates the element with new key
-      {
+      else if (command == "d" || command == "i" || command == "u")
+      {                                 //Updates the element with new key
          input.erase(0,input.find(' ')+1);
          inputId = input.substr(0,input.find(' '));
          input.erase(0,input.find(' ')+1);
@@ -62,23 +556,95 @@ int main()
          ss << inputKeyString;
          if (stringstream(inputKeyString) >> inputKey)
          {  
-            if(!inputId.empty())
+            typename Queue::Handle* handle = liveHandle(handles, myMPQ,
+                                                        inputId);
+            if (handle != NULL)
             {
-               if(myMPQ.isMember(inputId))
-               {
-                  myMPQ.decreaseKey(inputId, inputKey);  
-               }
+               if (command == "d")
+                  myMPQ.decreaseKey(*handle, inputKey);
+               else if (command == "i")
+                  myMPQ.increaseKey(*handle, inputKey);
+               else
+                  myMPQ.updateKey(*handle, inputKey);
             }
          }
       }  
+      else if (command == "e")       //Erases the element of an id
+      {
+         input.erase(0,input.find(' ')+1);
+         inputId = input.substr(0,input.find(' '));
+         typename Queue::Handle* handle = liveHandle(handles, myMPQ,
+                                                     inputId);
+         if (handle != NULL)
+         {
+            myMPQ.erase(*handle);
+            liveHandle(handles, myMPQ, inputId); //Drops the erased handle
+         }
+      }
+      else if (command == "l")       //Loads a file of "id key" lines
+      {
+         input.erase(0,input.find(' ')+1);
+         loadFile(input.substr(0,input.find(' ')), myMPQ, handles);
+      }
+      else if (command == "t")       //Prints the k smallest of a file
+      {
+         input.erase(0,input.find(' ')+1);
+         inputKeyString = input.substr(0,input.find(' '));
+         input.erase(0,input.find(' ')+1);
+         if (stringstream(inputKeyString) >> inputKey)
+         {
+            vector<string> ids = topOfFile(input.substr(0,input.find(' ')),
+                                           inputKey);
+            for (size_t i = 0; i < ids.size(); i++)
+               cout<< ids[i] << endl;
+         }
+      }
       else if (command == "x")       //Extracts the minimum key and prints
       {
-         cout<< myMPQ.extractMin() << endl;      
+         if (myMPQ.empty())
+            cout<< "empty" << endl;
+         else
+         {
+            string id = myMPQ.extractMin();
+            liveHandle(handles, myMPQ, id);   //Drops the extracted handle
+            cout<< id << endl;
+         }
       }
       else if (command == "q")      //Quits the program
       {
-         exit(0);
+         break;
       }
    }
+   reportMetrics(myMPQ);
+}
+
+/**
+ * Desc: main function which is the test driver for the program. It processes 
+ *       all commands, inputs and calls the desired function for maintaining
+ *       minpriority queue.
+ * In:   Arguments - "-f" selects fast mode, "-r" the radix heap instead of
+ *       the binary heap. Uses input from the user and processes it.
+ * Out:  Returns 0 - Integer. Calls desired function as per input from user.
+ *
+ */
+
+int main(int argc, char* argv[])
+{
+   bool fast = false, radix = false;
+   for (int i = 1; i < argc; i++)
+   {
+      if (string(argv[i]) == "-f")
+         fast = true;
+      else if (string(argv[i]) == "-r")
+         radix = true;
+   }
+   if (fast && radix)
+      FastDriver<RadixQ>().run();
+   else if (fast)
+      FastDriver<MinPriorityQ<> >().run();
+   else if (radix)
+      runLines<RadixQ>();
+   else
+      runLines<MinPriorityQ<> >();
    return 0;
 }
@@ -3,6 +3,37 @@
  *  @desc: Header file which inlcudes functions necessary for implmenting
  *         minimum priority queue.
  *
+ *         MinPriorityQ<Id, Key, Compare> keeps its elements by value in one
+ *         contiguous vector, so the sifts walk neighbouring memory and an
+ *         insert allocates nothing beyond the vector's own growth. Ids are
+ *         only ever moved, move-only ids such as unique_ptr work too.
+ *
+ *         Ids live in a table of slots, the heap itself only holds (key,
+ *         slot) pairs and every slot knows the heap position of its
+ *         element. insert returns a Handle naming the slot, decreaseKey,
+ *         erase and contains find an element through it in O(1) instead of
+ *         comparing ids across the heap. A slot is reused once its element
+ *         is gone, the generation in the Handle tells a stale handle apart.
+ *
+ *         Keys can move either way: increaseKey and updateKey sift the
+ *         element down or up and erase takes out any element, each O(log n)
+ *         once the element is found. The id overloads find it by a scan,
+ *         callers which keep the handle skip that.
+ *
+ *         meld empties another queue into this one. The elements are moved
+ *         over and the heap is rebuilt bottom up in O(n + m), or the few
+ *         new elements are sifted up, instead of extracting and reinserting
+ *         each of them.
+ *
+ *         Arity picks a d-ary heap at compile time. Wider heaps are flatter
+ *         and read all children of a node from one cache line when a group
+ *         of them fits into it, the storage is aligned to make that so.
+ *         The default MinPriorityQ<> is the string/int queue of main.cpp.
+ *
+ *         Built with -DMPQ_METRICS the queue counts its operations, key
+ *         comparisons and sift levels and times every operation, see
+ *         pqmetrics.h. Without it the hooks compile to nothing.
+ *
  *  @author: Diney Wankhede
  *  @date: 4/22/15
  *
@@ -13,39 +44,897 @@
 
 #include <string>
 #include <vector>
+#include <functional>
+#include <utility>
+#include <cstddef>
+#include <algorithm>
+#include <stdint.h>
+#include "alignedallocator.h"
+#include "pqmetrics.h"
 
 
 using std::string;
 using std::vector;
 
+template <typename Id = string, typename Key = int,
+          typename Compare = std::less<Key>, size_t Arity = 2>
 class MinPriorityQ
 {
 public:
+   class Handle                 //Names one inserted element
+   {
+   public:
+      Handle();                 //Handle of no element
+   private:
+      friend class MinPriorityQ;
+      Handle(uint32_t,uint32_t);
+      uint32_t slot;            //Slot of the element
+      uint32_t generation;      //Generation of the slot at insert
+   };
+
    MinPriorityQ();              // Constructor
+   explicit MinPriorityQ(const Compare&); //Constructor with a key order
    ~MinPriorityQ();             //Destructor
    
-   void insert(string,int);     //Function to insert an entry into heap
-   void decreaseKey(string,int);//Descreases key when new key is input
-   string extractMin();         //Extracts minimum from queue and removes it
-   bool isMember(string);       //Checks if the input id is present or not
+   Handle insert(Id,Key);       //Function to insert an entry into heap
+   template <typename InputIt>  //Inserts a range of (id, key) pairs
+   void bulkInsert(InputIt first, InputIt last);
+   template <typename InputIt, typename OutputIt> //Same, writes the handles
+   void bulkInsert(InputIt first, InputIt last, OutputIt handles);
+   void decreaseKey(const Id&,Key);//Descreases key when new key is input
+   void decreaseKey(Handle,Key);//Same, located through the handle
+   void increaseKey(const Id&,Key);//Raises the key, a smaller one is ignored
+   void increaseKey(Handle,Key);//Same, located through the handle
+   void updateKey(const Id&,Key);//Sets the key, either direction
+   void updateKey(Handle,Key);  //Same, located through the handle
+   Id extractMin();             //Extracts minimum from queue and removes it
+   Id replaceMin(Id,Key);       //Extracts the minimum and inserts, one sift
+   bool erase(const Id&);       //Removes an element, false if not queued
+   bool erase(Handle);          //Same, located through the handle
+   void meld(MinPriorityQ&&);   //Takes every element of the other queue
+   bool isMember(const Id&) const;//Checks if the input id is present or not
+   bool contains(Handle) const; //True while the element is queued
+   const Key& minKey() const;   //Key of the minimum, queue must not be empty
+   const Key& key(Handle) const;//Key of an element which is still queued
+   template <typename Function> //Maps every key, f must keep their order
+   void rekey(Function f);
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements in the queue
+#ifdef MPQ_METRICS
+   const PQMetrics& metrics() const;//Counts and latencies so far
+   void resetMetrics();         //Starts counting afresh
+#endif
    
 private:
    class Element                //Private Class
    {
    public:
-      Element(string,int);      //Copy constructor
-      ~Element();               //Destructor
-      string id;                //String id to store 
-      int key;                  //Key int which is to be used and compared
+      Element(const Key&,uint32_t);//Copy constructor
+      Key key;                  //Key which is to be used and compared
+      uint32_t slot;            //Slot of the id
    };
+   class Slot                   //Id and heap position of an element
+   {
+   public:
+      Slot(Id&&);               //Moves the id in
+      Id id;                    //Id to store
+      size_t position;          //Index in minHeap, NONE when not queued
+      uint32_t generation;      //Bumped every time the slot is freed
+   };
+   class NoHandles              //Output iterator dropping the handles
+   {
+   public:
+      NoHandles& operator*() { return *this; }
+      NoHandles& operator++() { return *this; }
+      NoHandles& operator=(const Handle&) { return *this; }
+   };
+   static const size_t NONE = (size_t)-1;
    
+   //A group of Arity children fills (part of) a cache line when it fits,
+   //the storage is then offset so that every group starts on a boundary
+   static const size_t GROUP = Arity * sizeof(Element);
+   static const size_t ALIGN = (GROUP & (GROUP - 1)) == 0 && GROUP <= 64
+                               ? GROUP : GROUP % 64 == 0 ? 64
+                               : alignof(Element);
+   static const size_t OFFSET = sizeof(Element) % ALIGN;
+   typedef AlignedAllocator<Element,ALIGN,OFFSET> Allocator;
+
+   uint32_t newSlot(Id&&);      //Slot for a new element
+   void releaseSlot(uint32_t);  //Frees the slot of a removed element
+   void place(size_t,Element&&);//Stores an element and its position
+   void removeAt(size_t);       //Removes the element at a position
+   void decreaseAt(size_t,Key); //Lowers the key at a position
+   void updateAt(size_t,Key);   //Sets the key at a position
+   size_t find(const Id&) const;//Position of an id, NONE if not queued
+   void restoreHeap(size_t);    //Heap order after appending from a position
    void buildMinHeap();         //Function which builds heap after alteration
-   void minHeapify(int);        //Called by buildMaxHeap () 
-   int parent(int);             //Fetches the parent of input
-   int left(int);               //Fetches the left child of input
-   int right(int);              //Fecthes the right chicldof input
+   void minHeapify(size_t);     //Called by buildMaxHeap () 
+   void siftUp(size_t);         //Moves an element up to its place
+   size_t minChild(size_t) const;//Smallest of the children of a position
+   size_t parent(size_t) const; //Fetches the parent of input
+   size_t child(size_t) const;  //Fetches the first child of input
+   bool before(const Key&,const Key&) const;//Compares two keys
 
-   vector<Element*> minHeap;    //Vector of type element which stores Heap
+   vector<Element,Allocator> minHeap; //Elements by value, the heap itself
+   vector<Slot> slots;          //Ids by slot
+   vector<uint32_t> freeSlots;  //Slots ready for reuse
+   Compare compare;             //Order of the keys
+#ifdef MPQ_METRICS
+   mutable PQMetrics metricsData;//Counted even by const members
+#endif
 };
 
+/**
+ * Constructor for class MinPriorityQ.
+ *
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::MinPriorityQ()
+{
+
+}
+
+/**
+ * Desc: Constructor taking the object which orders the keys.
+ *
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::MinPriorityQ(const Compare& order)
+   : compare(order)
+{
+
+}
+
+/**
+ * Destructor for class MinPriorityQ.
+ * Elements are stored by value so the vector frees them.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::~MinPriorityQ()
+{
+
+}
+
+/**
+ * Desc: Constructor for setting the key and slot to the new Element which
+ *       will be insertd.
+ *
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::Element::Element(const Key& new_key,
+                                                     uint32_t new_slot)
+   : key(new_key), slot(new_slot)
+{
+
+}
+
+/**
+ * Desc: Constructor of a slot, the position is set when the element is
+ *       placed in the heap.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::Slot::Slot(Id&& new_id)
+   : id(std::move(new_id)), position(NONE), generation(0)
+{
+
+}
+
+/**
+ * Desc: Constructors of Handle. The default one names no element.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::Handle::Handle()
+   : slot(0xFFFFFFFFu), generation(0)
+{
+
+}
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MinPriorityQ<Id,Key,Compare,Arity>::Handle::Handle(uint32_t new_slot,
+                                                   uint32_t new_generation)
+   : slot(new_slot), generation(new_generation)
+{
+
+}
+
+/**
+ * Desc: Function to insert an element into the queue. Similar to algorithm
+ *       in Cormen.
+ *
+ * In:   Id - Id of the element, moved into the queue
+ *       Key - Key of the element
+ *
+ * Out:  Handle - names the element for decreaseKey, erase and contains
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+typename MinPriorityQ<Id,Key,Compare,Arity>::Handle
+MinPriorityQ<Id,Key,Compare,Arity>::insert(Id id, Key key)
+{
+   MPQ_OP(INSERT);
+   uint32_t slot = newSlot(std::move(id));
+   minHeap.push_back(Element(key,slot));
+   MPQ_GREW(minHeap.size());
+   slots[slot].position = minHeap.size() - 1;
+   siftUp(minHeap.size() - 1);
+   return Handle(slot, slots[slot].generation);
+}
+
+/**
+ * Desc: Inserts a range of (id, key) pairs at once. The pairs are appended
+ *       and the heap is rebuilt bottom up with Floyd's buildMinHeap, O(n)
+ *       instead of O(n log n) for n single inserts. A range that is small
+ *       next to the queue is sifted up one by one instead. Ids are moved
+ *       out of the range when it yields rvalues, e.g. a move_iterator.
+ *
+ * In:   InputIt - range of std::pair<Id, Key> or alike
+ *       OutputIt - optional, gets the handle of every pair in range order
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+template <typename InputIt>
+void MinPriorityQ<Id,Key,Compare,Arity>::bulkInsert(InputIt first, InputIt last)
+{
+   bulkInsert(first, last, NoHandles());
+}
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+template <typename InputIt, typename OutputIt>
+void MinPriorityQ<Id,Key,Compare,Arity>::bulkInsert(InputIt first, InputIt last,
+                                                    OutputIt handles)
+{
+   MPQ_OP(BULK);
+   typedef decltype(*first) Entry;
+   size_t old = minHeap.size();
+   for (; first != last; ++first)
+   {
+      Entry entry = *first;
+      uint32_t slot = newSlot(Id(std::forward<Entry>(entry).first));
+      minHeap.push_back(Element(entry.second,slot));
+      slots[slot].position = minHeap.size() - 1;
+      *handles = Handle(slot, slots[slot].generation);
+      ++handles;
+   }
+   MPQ_GREW(minHeap.size());
+   restoreHeap(old);
+}
+
+/**
+ * Desc: Function to decrease the key as and when an update is required.
+ *       A larger key or an id which is not queued is ignored.
+ *
+ * In:   Id - Id of the element
+ *       Key - The new key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::decreaseKey(const Id& id, Key key)
+{
+   MPQ_OP(DECREASE);
+   size_t i = find(id);
+   if (i != NONE)
+      decreaseAt(i, key);
+}
+
+/**
+ * Desc: Lowers the key of the element named by a handle. A larger key or a
+ *       handle whose element is gone is ignored.
+ *
+ * In:   Handle - returned by insert
+ *       Key - The new key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::decreaseKey(Handle handle, Key key)
+{
+   MPQ_OP(DECREASE);
+   if (contains(handle))
+      decreaseAt(slots[handle.slot].position, key);
+}
+
+/**
+ * Desc: Raises the key of an element, which then sifts down. A smaller key
+ *       or an element which is not queued is ignored.
+ *
+ * In:   Id or Handle - the element
+ *       Key - The new key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::increaseKey(const Id& id, Key key)
+{
+   MPQ_OP(INCREASE);
+   size_t i = find(id);
+   if (i != NONE && !before(key, minHeap[i].key))
+      updateAt(i, key);
+}
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::increaseKey(Handle handle, Key key)
+{
+   MPQ_OP(INCREASE);
+   if (!contains(handle))
+      return;
+   size_t i = slots[handle.slot].position;
+   if (!before(key, minHeap[i].key))
+      updateAt(i, key);
+}
+
+/**
+ * Desc: Sets the key of an element whichever way it moves, so schedulers
+ *       can reprioritize in place instead of queueing a duplicate.
+ *
+ * In:   Id or Handle - the element, ignored when not queued
+ *       Key - The new key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::updateKey(const Id& id, Key key)
+{
+   MPQ_OP(UPDATE);
+   size_t i = find(id);
+   if (i != NONE)
+      updateAt(i, key);
+}
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::updateKey(Handle handle, Key key)
+{
+   MPQ_OP(UPDATE);
+   if (contains(handle))
+      updateAt(slots[handle.slot].position, key);
+}
+
+/**
+ * Desc: This Function extracts and returns the id which is the minimum
+ *       and removes that particular element from the queue. The last
+ *       element takes the place of the root and sifts down, O(log n).
+ *
+ * In:   None - Using the member minHeap, which must not be empty.
+ * Out:  Id - Returns the minimum id, moved out of the queue.
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+Id MinPriorityQ<Id,Key,Compare,Arity>::extractMin()
+{
+   MPQ_OP(EXTRACT);
+   uint32_t slot = minHeap[0].slot;  //The minimum will be at 1st position
+   Id min = std::move(slots[slot].id);
+   removeAt(0);
+   releaseSlot(slot);
+   return min;
+}
+
+/**
+ * Desc: Extracts the minimum and inserts a new element in its place with a
+ *       single sift down, half the work of extractMin followed by insert.
+ *       The new element takes over the slot, handles of the old minimum go
+ *       stale.
+ *
+ * In:   Id - Id of the new element, Key - its key. The queue must not be
+ *       empty.
+ * Out:  Id - the id of the old minimum
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+Id MinPriorityQ<Id,Key,Compare,Arity>::replaceMin(Id id, Key key)
+{
+   MPQ_OP(REPLACE);
+   uint32_t slot = minHeap[0].slot;
+   Id min = std::move(slots[slot].id);
+   slots[slot].id = std::move(id);
+   slots[slot].generation++;
+   minHeap[0].key = key;
+   minHeapify(0);
+   return min;
+}
+
+/**
+ * Desc: Removes an element, O(log n) once it is found. Of equal ids the
+ *       first one found goes.
+ *
+ * In:   Id - Id of the element
+ * Out:  boolean - false when no such id is queued
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MinPriorityQ<Id,Key,Compare,Arity>::erase(const Id& id)
+{
+   MPQ_OP(ERASE);
+   size_t i = find(id);
+   if (i == NONE)
+      return false;
+   uint32_t slot = minHeap[i].slot;
+   removeAt(i);
+   Id(std::move(slots[slot].id));         //Frees what the id holds
+   releaseSlot(slot);
+   return true;
+}
+
+/**
+ * Desc: Removes the element named by a handle, O(log n).
+ *
+ * In:   Handle - returned by insert
+ * Out:  boolean - false when the element was already gone
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MinPriorityQ<Id,Key,Compare,Arity>::erase(Handle handle)
+{
+   MPQ_OP(ERASE);
+   if (!contains(handle))
+      return false;
+   removeAt(slots[handle.slot].position);
+   Id(std::move(slots[handle.slot].id));  //Frees what the id holds
+   releaseSlot(handle.slot);
+   return true;
+}
+
+/**
+ * Desc: Moves every element of the other queue into this one and leaves
+ *       the other queue empty. Ids and keys are moved, never copied. The
+ *       slots of the other queue are appended behind ours, so handles of
+ *       this queue stay valid while those of the other queue do not carry
+ *       over. Both queues must order their keys alike.
+ *
+ * In:   MinPriorityQ - queue to empty into this one
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::meld(MinPriorityQ&& other)
+{
+   if (&other == this)
+      return;
+   MPQ_OP(MELD);
+   size_t old = minHeap.size();
+   uint32_t base = (uint32_t)slots.size();
+   slots.reserve(slots.size() + other.slots.size());
+   for (size_t s = 0; s < other.slots.size(); s++)
+   {
+      slots.push_back(std::move(other.slots[s]));
+      if (slots.back().position != NONE)
+         slots.back().position += old;
+   }
+   for (size_t f = 0; f < other.freeSlots.size(); f++)
+      freeSlots.push_back(base + other.freeSlots[f]);
+   minHeap.reserve(old + other.minHeap.size());
+   for (size_t i = 0; i < other.minHeap.size(); i++)
+      minHeap.push_back(Element(other.minHeap[i].key,
+                                base + other.minHeap[i].slot));
+   other.minHeap.clear();
+   other.slots.clear();
+   other.freeSlots.clear();
+   MPQ_GREW(minHeap.size());
+   restoreHeap(old);
+}
+
+/**
+ * Desc: This function checks if the input id is present in the queue or not.
+ *
+ * In:   Id - id - The id which is to be searched.
+ * Out:  boolean - true if there exists input id in the queue else false.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MinPriorityQ<Id,Key,Compare,Arity>::isMember(const Id& id) const
+{
+   return find(id) != NONE;
+}
+
+/**
+ * Desc: True while the element named by a handle is in the queue.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MinPriorityQ<Id,Key,Compare,Arity>::contains(Handle handle) const
+{
+   return handle.slot < slots.size()
+          && slots[handle.slot].generation == handle.generation
+          && slots[handle.slot].position != NONE;
+}
+
+/**
+ * Desc: Key of the minimum without extracting it.
+ *
+ * In:   None - the queue must not be empty
+ * Out:  Key - the smallest key
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+const Key& MinPriorityQ<Id,Key,Compare,Arity>::minKey() const
+{
+   return minHeap[0].key;
+}
+
+/**
+ * Desc: Key of the element named by a handle, which must still be queued.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+const Key& MinPriorityQ<Id,Key,Compare,Arity>::key(Handle handle) const
+{
+   return minHeap[slots[handle.slot].position].key;
+}
+
+/**
+ * Desc: Replaces every key k by f(k) in heap order. As f must not change
+ *       the order of any two keys the heap stays valid without a sift.
+ *
+ * In:   Function - called with each key, returns its new key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+template <typename Function>
+void MinPriorityQ<Id,Key,Compare,Arity>::rekey(Function f)
+{
+   for (size_t i = 0; i < minHeap.size(); i++)
+      minHeap[i].key = f(minHeap[i].key);
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MinPriorityQ<Id,Key,Compare,Arity>::empty() const
+{
+   return minHeap.empty();
+}
+
+/**
+ * Desc: Number of elements in the queue.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MinPriorityQ<Id,Key,Compare,Arity>::size() const
+{
+   return minHeap.size();
+}
+
+#ifdef MPQ_METRICS
+
+/**
+ * Desc: Counts and latencies of the operations since construction or the
+ *       last resetMetrics.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+const PQMetrics& MinPriorityQ<Id,Key,Compare,Arity>::metrics() const
+{
+   return metricsData;
+}
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::resetMetrics()
+{
+   metricsData.reset();
+}
+
+#endif
+
+/**
+ * Desc: This function is written as per in Cormen. It maintains the minHeap
+ *       property on the in input position. The element is held aside and
+ *       the smaller children move up into the hole until it fits, one move
+ *       per level instead of a swap.
+ *
+ * In:   size_t - position of Element which is to be checked.
+ * Out:  Returns nothing - MinHeap proprty is maintained on input. 
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::minHeapify(size_t i)
+{
+   size_t size = minHeap.size();
+   if (child(i) >= size)
+      return;
+   Element moving = std::move(minHeap[i]);
+   while (child(i) < size)
+   {
+      size_t smallest = minChild(i);
+      if (!before(minHeap[smallest].key, moving.key))
+         break;
+      place(i, std::move(minHeap[smallest]));
+      i = smallest;
+      MPQ_COUNT(depth);
+   }
+   place(i, std::move(moving));
+   MPQ_SIFTED();
+}
+
+/**
+ * Desc: Moves the element at the input position up while its parent has a
+ *       larger key, as in Cormen's HEAP-DECREASE-KEY. Parents move down
+ *       into the hole, the element is written once at the end.
+ *
+ * In:   size_t - position of the element
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::siftUp(size_t i)
+{
+   if (i == 0 || !before(minHeap[i].key, minHeap[parent(i)].key))
+      return;
+   Element moving = std::move(minHeap[i]);
+   while(i > 0 && before(moving.key, minHeap[parent(i)].key))
+   {
+      place(i, std::move(minHeap[parent(i)]));
+      i = parent(i);
+      MPQ_COUNT(depth);
+   }
+   place(i, std::move(moving));
+   MPQ_SIFTED();
+}
+
+/**
+ * Desc: Stores an element at a heap position and records the position in
+ *       its slot. Every move of the sifts goes through here.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::place(size_t i, Element&& element)
+{
+   minHeap[i] = std::move(element);
+   slots[minHeap[i].slot].position = i;
+}
+
+/**
+ * Desc: Removes the element at a heap position. The last element takes its
+ *       place and sifts up or down, whichever way its key requires.
+ *
+ * In:   size_t - position of the element
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::removeAt(size_t i)
+{
+   slots[minHeap[i].slot].position = NONE;
+   size_t last = minHeap.size() - 1;
+   if (i != last)
+      place(i, std::move(minHeap[last]));
+   minHeap.pop_back();
+   if (i == last)
+      return;
+   if (i > 0 && before(minHeap[i].key, minHeap[parent(i)].key))
+      siftUp(i);
+   else
+      minHeapify(i);
+}
+
+/**
+ * Desc: Lowers the key at a heap position, a larger key is ignored.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::decreaseAt(size_t i, Key key)
+{
+   if(before(minHeap[i].key, key))
+      return;
+   minHeap[i].key = key;
+   siftUp(i);
+}
+
+/**
+ * Desc: Sets the key at a heap position and sifts the element up or down,
+ *       whichever way the new key requires.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::updateAt(size_t i, Key key)
+{
+   bool up = before(key, minHeap[i].key);
+   minHeap[i].key = key;
+   if (up)
+      siftUp(i);
+   else
+      minHeapify(i);
+}
+
+/**
+ * Desc: Restores the heap order after elements were appended behind the
+ *       heap. A large batch is cheaper to rebuild bottom up with Floyd's
+ *       buildMinHeap, a small one is sifted up element by element.
+ *
+ * In:   size_t - size of the heap before the elements were appended
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::restoreHeap(size_t old)
+{
+   if (minHeap.size() - old > old / 8)   //Rebuilding is cheaper
+      buildMinHeap();
+   else
+   {
+      for (size_t i = old; i < minHeap.size(); i++)
+         siftUp(i);
+   }
+}
+
+/**
+ * Desc: Scans the heap for an id.
+ *
+ * In:   Id - The id which is to be searched.
+ * Out:  size_t - its heap position, NONE when it is not queued
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MinPriorityQ<Id,Key,Compare,Arity>::find(const Id& id) const
+{
+   for (size_t i = 0; i < minHeap.size(); i++)
+   {
+      if (slots[minHeap[i].slot].id == id)
+         return i;
+   }
+   return NONE;
+}
+
+/**
+ * Desc: Slot for the id of a new element, a freed one when there is one.
+ *
+ * In:   Id - moved into the slot
+ * Out:  uint32_t - the slot
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+uint32_t MinPriorityQ<Id,Key,Compare,Arity>::newSlot(Id&& id)
+{
+   if (freeSlots.empty())
+   {
+      slots.push_back(Slot(std::move(id)));
+      return (uint32_t)(slots.size() - 1);
+   }
+   uint32_t slot = freeSlots.back();
+   freeSlots.pop_back();
+   slots[slot].id = std::move(id);
+   return slot;
+}
+
+/**
+ * Desc: Frees a slot whose element left the heap. The new generation makes
+ *       every handle of the old element stale.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::releaseSlot(uint32_t slot)
+{
+   slots[slot].position = NONE;
+   slots[slot].generation++;
+   freeSlots.push_back(slot);
+}
+
+/**
+ * Desc: Finds the child with the smallest key. A full group of 4 or 8
+ *       children is scanned with a fixed trip count and a select per child,
+ *       which the compiler unrolls into conditional moves instead of hard to
+ *       predict branches. The binary heap keeps the branch: with only one
+ *       compare per level the processor runs ahead into the next level on
+ *       the predicted path, which pays more on large heaps.
+ *
+ * In:   size_t - position which has at least one child
+ * Out:  size_t - position of its smallest child
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MinPriorityQ<Id,Key,Compare,Arity>::minChild(size_t i) const
+{
+   size_t first = child(i);
+   size_t count = std::min(Arity, minHeap.size() - first);
+   if (Arity == 2 || count < Arity)
+   {
+      size_t smallest = first;
+      for (size_t c = first + 1; c < first + count; c++)
+      {
+         if (before(minHeap[c].key, minHeap[smallest].key))
+            smallest = c;
+      }
+      return smallest;
+   }
+   const Element* group = &minHeap[first];
+   size_t smallest = 0;
+   Key smallestKey = group[0].key;
+   for (size_t c = 1; c < Arity; c++)
+   {
+      bool smaller = before(group[c].key, smallestKey);
+      smallest = smaller ? c : smallest;
+      smallestKey = smaller ? group[c].key : smallestKey;
+   }
+   return first + smallest;
+}
+
+/**
+ * Desc: This function builds Min Heap by maintaining min Heap property.
+ *       Heapifies every inner node from the last one up, O(n) in total.
+ *
+ * In:   None. 
+ * Out:  Returns nothing - Min Heap property of entire heap.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MinPriorityQ<Id,Key,Compare,Arity>::buildMinHeap()
+{
+   if (minHeap.size() < 2)
+      return;
+   for(size_t i = parent(minHeap.size() - 1) + 1; i-- > 0; )
+      minHeapify(i);
+}
+
+/**
+ * Desc: This Function looks for the parent of input position.
+ * 
+ * In:   size_t - The input position whose parent is required.
+ * Out:  size_t - The parent's position of input in the heap.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MinPriorityQ<Id,Key,Compare,Arity>::parent(size_t i) const
+{
+   return (i - 1) / Arity;
+}
+
+/**
+ * Desc: This Function looks for the first child of input position, the
+ *       Arity children of a position are next to each other.
+ * 
+ * In:   size_t - The input position whose children are required.
+ * Out:  size_t - The first child's position of input in the heap.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MinPriorityQ<Id,Key,Compare,Arity>::child(size_t i) const
+{
+   return Arity*i + 1;
+}
+
+/**
+ * Desc: Compares two keys with the order of the queue, every comparison of
+ *       the heap goes through here so that it can be counted.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MinPriorityQ<Id,Key,Compare,Arity>::before(const Key& a,
+                                                const Key& b) const
+{
+   MPQ_COUNT(comparisons);
+   return compare(a, b);
+}
+
+extern template class MinPriorityQ<>;  //Compiled once in minpriority.cpp
+
 #endif /* defined(____minpriority__) */
@@ -0,0 +1,231 @@
+/**
+ *  @file: multiqueue.h
+ *  @desc: MultiQueue, a relaxed concurrent min priority queue built from
+ *         c*p MinPriorityQs for p threads, each behind its own mutex.
+ *
+ *         insert puts the element into a random heap. extractMin looks at
+ *         two random heaps and takes the minimum of the one whose cached
+ *         smallest key is smaller. Locks are only ever tried, a thread
+ *         finding a heap busy picks other heaps instead of waiting, so
+ *         threads rarely contend. The result is not always the global
+ *         minimum, but its expected rank among the queued keys is O(c*p)
+ *         and does not grow with the number of elements.
+ *
+ *         The smallest key of every heap is cached in an atomic so that
+ *         the two choices are made without locking, Key must therefore be
+ *         trivially copyable (integers, doubles, small structs).
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____multiqueue__
+#define ____multiqueue__
+
+#include "minpriority.h"
+#include "alignedallocator.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <functional>
+#include <cstddef>
+
+template <typename Id, typename Key = int, typename Compare = std::less<Key>,
+          size_t Arity = 2>
+class MultiQueue
+{
+public:
+   explicit MultiQueue(size_t threads, size_t factor = 2); //c*p heaps
+   ~MultiQueue();               //Destructor
+
+   void insert(Id,Key);         //Adds an element to a random heap
+   bool extractMin(Id&);        //Removes a near minimum, false when empty
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements, exact when quiescent
+
+private:
+   class alignas(64) Shard      //One heap and what is known about it,
+                                //a multiple of a cache line in size
+   {
+   public:
+      Shard();                  //Constructor
+      std::mutex lock;          //Held while the heap is used
+      MinPriorityQ<Id,Key,Compare,Arity> heap;
+      std::atomic<Key> top;     //Smallest key, valid while filled
+      std::atomic<bool> filled; //False when the heap is empty
+   };
+
+   size_t pick();               //Random heap index of this thread
+   void publish(Shard&);        //Caches the smallest key of a locked heap
+
+   Shard* shards;               //Heaps, on cache lines of their own
+   size_t count;                //Number of heaps
+   std::atomic<size_t> elements;//Number of queued elements
+   Compare compare;             //Order of the keys
+   MultiQueue(const MultiQueue&);              //Not copyable
+   MultiQueue& operator=(const MultiQueue&);
+};
+
+/**
+ * Desc: Shard constructor, the heap starts empty.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MultiQueue<Id,Key,Compare,Arity>::Shard::Shard()
+   : top(Key()), filled(false)
+{
+
+}
+
+/**
+ * Desc: Constructor. The heaps are allocated 64 byte aligned and Shard is
+ *       padded to a multiple of 64 bytes, so every heap starts a cache line
+ *       and two threads working on neighbouring heaps do not share one.
+ *
+ * In:   size_t - number of threads p, size_t - heaps per thread c
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MultiQueue<Id,Key,Compare,Arity>::MultiQueue(size_t threads, size_t factor)
+   : count(threads * factor < 2 ? 2 : threads * factor), elements(0)
+{
+   shards = AlignedAllocator<Shard,64>().allocate(count);
+   for (size_t i = 0; i < count; i++)
+      new (shards + i) Shard();
+}
+
+/**
+ * Desc: Destructor, destroys the heaps and their elements.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+MultiQueue<Id,Key,Compare,Arity>::~MultiQueue()
+{
+   for (size_t i = 0; i < count; i++)
+      shards[i].~Shard();
+   AlignedAllocator<Shard,64>().deallocate(shards, count);
+}
+
+/**
+ * Desc: Adds an element to a random heap which is not locked right now.
+ *
+ * In:   Id - moved into the queue, Key - its key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MultiQueue<Id,Key,Compare,Arity>::insert(Id id, Key key)
+{
+   for (;;)
+   {
+      Shard& shard = shards[pick()];
+      if (!shard.lock.try_lock())
+         continue;
+      shard.heap.insert(std::move(id), key);
+      publish(shard);
+      elements.fetch_add(1, std::memory_order_relaxed);
+      shard.lock.unlock();
+      return;
+   }
+}
+
+/**
+ * Desc: Removes the minimum of the better of two random heaps. Busy or
+ *       empty picks are retried with new heaps until an element is taken
+ *       or the whole queue is found empty.
+ *
+ * In:   Id& - gets the id of the removed element
+ * Out:  boolean - false when the queue was empty
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MultiQueue<Id,Key,Compare,Arity>::extractMin(Id& id)
+{
+   for (;;)
+   {
+      if (elements.load(std::memory_order_acquire) == 0)
+         return false;
+      Shard* a = &shards[pick()];
+      Shard* b = &shards[pick()];
+      bool aFilled = a->filled.load(std::memory_order_relaxed);
+      bool bFilled = b->filled.load(std::memory_order_relaxed);
+      if (!aFilled && !bFilled)
+         continue;
+      if (!aFilled || (bFilled && compare(b->top.load(std::memory_order_relaxed),
+                                          a->top.load(std::memory_order_relaxed))))
+         a = b;
+      if (!a->lock.try_lock())
+         continue;
+      if (a->heap.empty())                     //Emptied since the look
+      {
+         a->lock.unlock();
+         continue;
+      }
+      id = a->heap.extractMin();
+      publish(*a);
+      elements.fetch_sub(1, std::memory_order_release);
+      a->lock.unlock();
+      return true;
+   }
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+bool MultiQueue<Id,Key,Compare,Arity>::empty() const
+{
+   return elements.load(std::memory_order_acquire) == 0;
+}
+
+/**
+ * Desc: Number of elements in the queue. With other threads at work this
+ *       is only a snapshot.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MultiQueue<Id,Key,Compare,Arity>::size() const
+{
+   return elements.load(std::memory_order_acquire);
+}
+
+/**
+ * Desc: Random heap index. Every thread has its own generator, seeded from
+ *       its thread id, so picking needs no synchronization.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+size_t MultiQueue<Id,Key,Compare,Arity>::pick()
+{
+   static thread_local std::minstd_rand random(
+      (unsigned)std::hash<std::thread::id>()(std::this_thread::get_id()));
+   return random() % count;
+}
+
+/**
+ * Desc: Refreshes the cached smallest key of a heap whose lock is held.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare, size_t Arity>
+void MultiQueue<Id,Key,Compare,Arity>::publish(Shard& shard)
+{
+   if (shard.heap.empty())
+      shard.filled.store(false, std::memory_order_relaxed);
+   else
+   {
+      shard.top.store(shard.heap.minKey(), std::memory_order_relaxed);
+      shard.filled.store(true, std::memory_order_relaxed);
+   }
+}
+
+#endif /* defined(____multiqueue__) */
@@ -0,0 +1,412 @@
+/**
+ *  @file: pairingheap.h
+ *  @desc: Pairing heap, a min priority queue with O(1) insert, meld and
+ *         amortized o(log n) decreaseKey, for callers that lower keys far
+ *         more often than they extract (Dijkstra on dense graphs).
+ *
+ *         insert returns a Handle to the node of the element, decreaseKey
+ *         takes that handle so no id has to be looked up. Nodes come from
+ *         chunks owned by the heap and are recycled through a free list,
+ *         an insert allocates only when every chunk is full.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____pairingheap__
+#define ____pairingheap__
+
+#include <vector>
+#include <functional>
+#include <utility>
+#include <cstddef>
+#include <new>
+#include <cstring>
+
+using std::vector;
+
+template <typename Id, typename Key, typename Compare = std::less<Key> >
+class PairingHeap
+{
+   class Node;
+public:
+   typedef Node* Handle;        //Stays valid until its element is extracted
+
+   PairingHeap();               //Constructor
+   explicit PairingHeap(const Compare&); //Constructor with a key order
+   ~PairingHeap();              //Destructor
+
+   Handle insert(Id,Key);       //Adds an element, O(1)
+   void decreaseKey(Handle,Key);//Lowers the key of an element
+   Id extractMin();             //Removes the minimum, heap must not be empty
+   const Key& key(Handle) const;//Key of an element
+   const Id& id(Handle) const;  //Id of an element
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements in the heap
+   void meld(PairingHeap&);     //Takes every element of the other heap
+   void clear();                //Removes every element
+
+private:
+   class Node
+   {
+   public:
+      Node(Id&&,const Key&);    //Moves the id in
+      Id id;
+      Key key;
+      Node* child;              //Leftmost child
+      Node* sibling;            //Next sibling to the right
+      Node* prev;               //Left sibling, or parent when leftmost
+   };
+
+   static const size_t CHUNK = 1024;  //Nodes per chunk
+
+   Node* link(Node*,Node*);     //Smaller root adopts the other
+   Node* mergePairs(Node*);     //Two pass merge of a sibling list
+   void cut(Node*);             //Detaches a subtree from its parent
+   Node* allocate();            //Storage for one node
+   void release(Node*);         //Returns the storage of a node
+   void destroyAll();           //Destroys every node in the tree
+
+   Node* root;                  //Minimum element, NULL when empty
+   size_t count;                //Number of elements
+   Compare compare;             //Order of the keys
+   vector<Node*> chunks;        //Node storage, the last one is filled
+   size_t chunkUsed;            //Nodes handed out of the last chunk
+   Node* freeList;              //Released nodes, linked in their storage
+   vector<Node*> pairs;         //Scratch list of mergePairs
+   PairingHeap(const PairingHeap&);            //Not copyable
+   PairingHeap& operator=(const PairingHeap&);
+};
+
+/**
+ * Desc: Constructors, the heap starts empty without any chunk.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+PairingHeap<Id,Key,Compare>::PairingHeap()
+   : root(NULL), count(0), chunkUsed(CHUNK), freeList(NULL)
+{
+
+}
+
+template <typename Id, typename Key, typename Compare>
+PairingHeap<Id,Key,Compare>::PairingHeap(const Compare& order)
+   : root(NULL), count(0), compare(order), chunkUsed(CHUNK), freeList(NULL)
+{
+
+}
+
+/**
+ * Desc: Destructor, destroys the remaining elements and frees the chunks.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+PairingHeap<Id,Key,Compare>::~PairingHeap()
+{
+   destroyAll();
+   for (size_t i = 0; i < chunks.size(); i++)
+      ::operator delete(chunks[i]);
+}
+
+template <typename Id, typename Key, typename Compare>
+PairingHeap<Id,Key,Compare>::Node::Node(Id&& new_id, const Key& new_key)
+   : id(std::move(new_id)), key(new_key), child(NULL), sibling(NULL),
+     prev(NULL)
+{
+
+}
+
+/**
+ * Desc: Adds an element as a one node tree linked with the root.
+ *
+ * In:   Id - moved into the heap, Key - its key
+ * Out:  Handle - node of the element, for decreaseKey
+ */
+
+template <typename Id, typename Key, typename Compare>
+typename PairingHeap<Id,Key,Compare>::Handle
+PairingHeap<Id,Key,Compare>::insert(Id id, Key key)
+{
+   Node* node = new (allocate()) Node(std::move(id), key);
+   root = root == NULL ? node : link(root, node);
+   count++;
+   return node;
+}
+
+/**
+ * Desc: Lowers the key of an element. Its subtree is cut off and linked
+ *       with the root unless it is a leftmost child which still is not
+ *       smaller than its parent. A larger key is ignored.
+ *
+ * In:   Handle - element which is still in the heap, Key - the new key
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void PairingHeap<Id,Key,Compare>::decreaseKey(Handle node, Key key)
+{
+   if (compare(node->key, key))
+      return;
+   node->key = key;
+   if (node == root)
+      return;
+   if (node->prev->child == node && !compare(key, node->prev->key))
+      return;                           //Still in order below its parent
+   cut(node);
+   root = link(root, node);
+}
+
+/**
+ * Desc: Removes the root and merges its children in two passes.
+ *
+ * In:   None - the heap must not be empty
+ * Out:  Id - id of the minimum, moved out of the heap
+ */
+
+template <typename Id, typename Key, typename Compare>
+Id PairingHeap<Id,Key,Compare>::extractMin()
+{
+   Node* min = root;
+   Id id = std::move(min->id);
+   root = mergePairs(min->child);
+   release(min);
+   count--;
+   return id;
+}
+
+/**
+ * Desc: Key and id of an element which is still in the heap.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+const Key& PairingHeap<Id,Key,Compare>::key(Handle node) const
+{
+   return node->key;
+}
+
+template <typename Id, typename Key, typename Compare>
+const Id& PairingHeap<Id,Key,Compare>::id(Handle node) const
+{
+   return node->id;
+}
+
+/**
+ * Desc: This function checks if the heap has no element left.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+bool PairingHeap<Id,Key,Compare>::empty() const
+{
+   return root == NULL;
+}
+
+/**
+ * Desc: Number of elements in the heap.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+size_t PairingHeap<Id,Key,Compare>::size() const
+{
+   return count;
+}
+
+/**
+ * Desc: Moves every element of the other heap into this one by linking
+ *       the two roots. The other heap's chunks come along, so its handles
+ *       stay valid and now belong to this heap, the other heap is left
+ *       empty. Costs O(1) plus the chunk and free lists of the other heap.
+ *
+ * In:   PairingHeap - heap to empty into this one
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void PairingHeap<Id,Key,Compare>::meld(PairingHeap& other)
+{
+   if (&other == this)
+      return;
+   if (other.root != NULL)
+      root = root == NULL ? other.root : link(root, other.root);
+   count += other.count;
+
+   //Our last chunk stays the one being filled
+   chunks.insert(chunks.begin(), other.chunks.begin(), other.chunks.end());
+   while (other.freeList != NULL)
+   {
+      Node* node = other.freeList;
+      memcpy(&other.freeList, (void*)node, sizeof(Node*));
+      memcpy((void*)node, &freeList, sizeof(Node*));
+      freeList = node;
+   }
+
+   other.root = NULL;
+   other.count = 0;
+   other.chunks.clear();
+   other.chunkUsed = CHUNK;
+}
+
+/**
+ * Desc: Removes every element, the chunks are kept for reuse.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void PairingHeap<Id,Key,Compare>::clear()
+{
+   destroyAll();
+   root = NULL;
+   count = 0;
+}
+
+/**
+ * Desc: Makes the root with the larger key the leftmost child of the
+ *       other one.
+ *
+ * In:   Node*, Node* - two roots without siblings
+ * Out:  Node* - the new root
+ */
+
+template <typename Id, typename Key, typename Compare>
+typename PairingHeap<Id,Key,Compare>::Node*
+PairingHeap<Id,Key,Compare>::link(Node* a, Node* b)
+{
+   if (compare(b->key, a->key))
+      std::swap(a, b);
+   b->sibling = a->child;
+   if (a->child != NULL)
+      a->child->prev = b;
+   b->prev = a;
+   a->child = b;
+   a->sibling = NULL;
+   a->prev = NULL;
+   return a;
+}
+
+/**
+ * Desc: Links the siblings in pairs from left to right, then links the
+ *       pairs from right to left into one tree. Iterative, the pairs are
+ *       kept in a scratch vector so deep heaps do not recurse.
+ *
+ * In:   Node* - leftmost of a sibling list, may be NULL
+ * Out:  Node* - root of the merged tree, NULL for an empty list
+ */
+
+template <typename Id, typename Key, typename Compare>
+typename PairingHeap<Id,Key,Compare>::Node*
+PairingHeap<Id,Key,Compare>::mergePairs(Node* first)
+{
+   if (first == NULL)
+      return NULL;
+   pairs.clear();
+   while (first != NULL)
+   {
+      Node* a = first;
+      Node* b = a->sibling;
+      if (b == NULL)
+      {
+         a->prev = NULL;
+         pairs.push_back(a);
+         break;
+      }
+      first = b->sibling;
+      a->sibling = b->sibling = NULL;
+      pairs.push_back(link(a, b));
+   }
+   Node* merged = pairs.back();
+   for (size_t i = pairs.size() - 1; i-- > 0; )
+      merged = link(pairs[i], merged);
+   return merged;
+}
+
+/**
+ * Desc: Detaches a node and its subtree from its parent and siblings.
+ *
+ * In:   Node* - a node which is not the root
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void PairingHeap<Id,Key,Compare>::cut(Node* node)
+{
+   if (node->prev->child == node)
+      node->prev->child = node->sibling;
+   else
+      node->prev->sibling = node->sibling;
+   if (node->sibling != NULL)
+      node->sibling->prev = node->prev;
+   node->sibling = NULL;
+   node->prev = NULL;
+}
+
+/**
+ * Desc: Storage for one node, from the free list or the last chunk. A new
+ *       chunk is allocated when both are used up.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+typename PairingHeap<Id,Key,Compare>::Node*
+PairingHeap<Id,Key,Compare>::allocate()
+{
+   if (freeList != NULL)
+   {
+      Node* node = freeList;
+      memcpy(&freeList, (void*)node, sizeof(Node*));
+      return node;
+   }
+   if (chunkUsed == CHUNK)
+   {
+      chunks.push_back((Node*)::operator new(CHUNK * sizeof(Node)));
+      chunkUsed = 0;
+   }
+   return chunks.back() + chunkUsed++;
+}
+
+/**
+ * Desc: Destroys the element of a node and puts the node on the free
+ *       list, the link to the next free node is kept in its first bytes.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void PairingHeap<Id,Key,Compare>::release(Node* node)
+{
+   node->~Node();
+   memcpy((void*)node, &freeList, sizeof(Node*));
+   freeList = node;
+}
+
+/**
+ * Desc: Releases every node of the tree, walking it without recursion by
+ *       splicing each child list into the list of nodes still to visit.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+void PairingHeap<Id,Key,Compare>::destroyAll()
+{
+   Node* pending = root;                //Linked through sibling
+   while (pending != NULL)
+   {
+      Node* node = pending;
+      pending = node->sibling;
+      if (node->child != NULL)
+      {
+         Node* last = node->child;
+         while (last->sibling != NULL)
+            last = last->sibling;
+         last->sibling = pending;
+         pending = node->child;
+      }
+      release(node);
+   }
+   root = NULL;
+}
+
+#endif /* defined(____pairingheap__) */
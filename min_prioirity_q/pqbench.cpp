@@ -0,0 +1,989 @@
+/**
+ * @file: pqbench.cpp
+ * @desc: Regression and benchmark harness for MinPriorityQ.
+ *
+ *        pqbench -check [-n ops] [-s seed]
+ *           Runs a random stream of a/d/i/u/e/x commands through the binary,
+ *           4-ary and 8-ary MinPriorityQ and a std::set model, every
+ *           extract must return an id whose key is the smallest queued key.
+ *           Every other update or erase goes through the handle of the id.
+ *        pqbench -gen [-n ops] [-s seed]
+ *           Prints the same stream in the syntax of main.cpp, to be piped
+ *           into ./minpq.
+ *        pqbench -ties [-n ops] [-s seed]
+ *           Prints runs of adds with keys 0 .. 5 and runs of extracts in the
+ *           syntax of main.cpp. Every id is its key, an underscore and a
+ *           serial number, so the keys extracted can be compared where the
+ *           ids of equal keys may come out in another order.
+ *        pqbench [-m maxlog] [-k ops]
+ *           Fills the queue to 2^10 .. 2^maxlog elements and prints the mean
+ *           ns of an insert, an extract and a decreaseKey at each size.
+ *           Insert and extract should grow with log2(n). decreaseKey still
+ *           finds its id by a scan and grows with n.
+ *        pqbench -arity [-m maxexp] [-k ops]
+ *           Compares the binary heap with the 4-ary and 8-ary heaps on
+ *           integer ids and keys at 10^4 .. 10^maxexp (default 7) elements:
+ *           ns per element of a bulk build and ns per extract/insert pair.
+ *        pqbench -multi [-t threads] [-k ops]
+ *           Runs 1 .. threads threads (doubling) of extract/insert pairs on
+ *           a MultiQueue and on one MinPriorityQ behind a mutex and prints
+ *           the ns per pair over all threads. Then drains a MultiQueue on
+ *           one thread and prints the mean and largest rank of the
+ *           extracted keys among those queued, 0 being the true minimum.
+ *           threads defaults to the number of cores.
+ *        pqbench -lockfree [-t threads] [-k ops]
+ *           Stress test and benchmark of the lock-free BucketQueue against
+ *           a locked MinPriorityQ at 1, 2, 4 .. threads (default 64)
+ *           threads. Each thread extracts an element and reinserts its id
+ *           ops times, afterwards every id must be found exactly once.
+ *           Prints ops per second and the 50th, 99th and 99.9th percentile
+ *           ns of an extract/insert pair.
+ *        pqbench -dup [-n elements]
+ *           Heavy duplicate keys: fills n elements whose keys take only 1,
+ *           16, 1024 or n distinct values and drains them, on MinPriorityQ
+ *           and on StableMinPriorityQ. Prints ns per insert and extract and
+ *           checks that the stable queue hands out equal keys FIFO.
+ *        pqbench -external [-n elements] [-spill elements] [-dir path]
+ *           Inserts n random 64 bit keys into an ExternalQ which spills runs
+ *           of the given size (default n / 16) to files in path (default
+ *           /tmp), then extracts them all and checks their order. Prints
+ *           ns per insert and extract next to the in-memory MinPriorityQ.
+ *        pqbench -radix [-m maxlog] [-k ops]
+ *           Monotone workloads on the binary and 4-ary MinPriorityQ and on
+ *           the RadixHeap at 2^10 .. 2^maxlog (default 20) elements, 64 bit
+ *           keys. timer: every step fires the earliest timer and sets it
+ *           again up to 2^16 ahead, every fourth step also re-arms a random
+ *           pending timer. simulation: every step takes the next event and
+ *           schedules one more, delays spread over 2^0 .. 2^40. Prints ns
+ *           per step and checks that keys never come out decreasing.
+ *
+ * @date: 04/22/2015
+ * @author: Diney Wankhede
+ *
+ */
+
+#include "minpriority.h"
+#include "multiqueue.h"
+#include "bucketqueue.h"
+#include "externalq.h"
+#include "stablepq.h"
+#include "radixheap.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <stdint.h>
+#include <climits>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+using std::string;
+using std::vector;
+using std::set;
+using std::map;
+using std::pair;
+using std::make_pair;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::mt19937_64;
+using std::to_string;
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Desc: One command of the random stream.
+ *
+ */
+
+class Command
+{
+public:
+   Command(char,const string&,int);  //Copy Constructor
+   char type;                        //'a', 'd', 'i', 'u', 'e' or 'x'
+   string id;                        //Unused for 'x'
+   int key;                          //Unused for 'x'
+};
+
+Command::Command(char new_type, const string& new_id, int new_key)
+{
+   type = new_type;
+   id = new_id;
+   key = new_key;
+}
+
+/*
+ * Desc: Random stream of commands. Adds and removals are equally likely so
+ *       the queue size wanders around instead of growing. Decreases,
+ *       increases, updates and erases mostly pick a queued id, now and then
+ *       one which already left. Every added id is new. The stream follows
+ *       its own model of the queue, queued keys are kept distinct so that
+ *       every extract is known in advance.
+ *
+ * In:   size_t - number of commands, uint64_t - seed
+ * Out:  vector<Command> - the stream
+ */
+
+vector<Command> makeStream(size_t count, uint64_t seed)
+{
+   mt19937_64 random(seed);
+   vector<Command> stream;
+   set<pair<int,string> > order;     //Queued (key, id)
+   set<int> keys;                    //Queued keys
+   vector<pair<string,int> > live;   //Queued ids, in no order
+   map<string,size_t> at;            //Index of an id in live
+   vector<string> gone;              //Ids which left the queue
+   for (size_t i = 0; i < count; i++)
+   {
+      int roll = (int)(random() % 20);
+      string id;
+      if (roll >= 8 && roll < 14)
+      {
+         if (!gone.empty() && random() % 8 == 0)
+            id = gone[random() % gone.size()];
+         else if (!live.empty())
+            id = live[random() % live.size()].first;
+      }
+      if (live.empty() || roll < 8)
+      {
+         int key = (int)(random() % 1000000);
+         while (!keys.insert(key).second)
+            key++;
+         id = "v" + to_string(i);
+         stream.push_back(Command('a', id, key));
+         order.insert(make_pair(key, id));
+         at[id] = live.size();
+         live.push_back(make_pair(id, key));
+         continue;
+      }
+      map<string,size_t>::iterator it = at.find(id);
+      if (roll < 12)
+      {
+         char type = "ddiu"[roll - 8];
+         int key = it == at.end() ? 0 : live[it->second].second;
+         if (type == 'd')
+            key -= (int)(random() % 1000);
+         else if (type == 'i')
+            key += (int)(random() % 1000);
+         else
+            key += (int)(random() % 2001) - 1000;
+         if (it != at.end() && key != live[it->second].second)
+         {
+            while (keys.count(key))       //Keeps the direction of the move
+               key += type == 'd' || (type == 'u' && random() % 2) ? -1 : 1;
+            int old = live[it->second].second;
+            keys.erase(old);
+            keys.insert(key);
+            order.erase(make_pair(old, id));
+            order.insert(make_pair(key, id));
+            live[it->second].second = key;
+         }
+         stream.push_back(Command(type, id, key));
+         continue;
+      }
+      if (roll < 14)
+         stream.push_back(Command('e', id, 0));
+      else
+      {
+         id = order.begin()->second;
+         it = at.find(id);
+         stream.push_back(Command('x', "", 0));
+      }
+      if (it == at.end())
+         continue;
+      int key = live[it->second].second;
+      keys.erase(key);
+      order.erase(make_pair(key, id));
+      live[it->second] = live.back();
+      at[live.back().first] = it->second;
+      live.pop_back();
+      at.erase(id);
+      gone.push_back(id);
+      if (gone.size() > 64)
+         gone.erase(gone.begin(), gone.begin() + 32);
+   }
+   return stream;
+}
+
+/*
+ * Desc: Replays a stream on the queue and on a std::set of (key, id) pairs.
+ *
+ * In:   Arity - of the MinPriorityQ<string, int> under test
+ *       vector<Command> - the stream
+ * Out:  Integer - 0 when every extract agreed with the model
+ */
+
+template <size_t Arity>
+int check(const vector<Command>& stream)
+{
+   typedef MinPriorityQ<string,int,std::less<int>,Arity> Queue;
+   Queue queue;
+   map<string,typename Queue::Handle> handles;
+   set<pair<int,string> > model;
+   map<string,int> keyOf;
+   size_t extracts = 0;
+   for (size_t i = 0; i < stream.size(); i++)
+   {
+      const Command& c = stream[i];
+      if (c.type == 'a')
+      {
+         handles[c.id] = queue.insert(c.id, c.key);
+         model.insert(make_pair(c.key, c.id));
+         keyOf[c.id] = c.key;
+      }
+      else if (c.type == 'e')
+      {
+         map<string,int>::iterator it = keyOf.find(c.id);
+         bool erased = i % 2 == 0 ? queue.erase(c.id)
+                                  : queue.erase(handles[c.id]);
+         if (erased != (it != keyOf.end()))
+         {
+            cerr << "erase(" << c.id << ") wrong at command " << i << endl;
+            return 1;
+         }
+         if (erased)
+         {
+            model.erase(make_pair(it->second, c.id));
+            keyOf.erase(it);
+         }
+      }
+      else if (c.type != 'x')
+      {
+         map<string,int>::iterator it = keyOf.find(c.id);
+         if (queue.isMember(c.id) != (it != keyOf.end()))
+         {
+            cerr << "isMember(" << c.id << ") wrong at command " << i << endl;
+            return 1;
+         }
+         if (queue.contains(handles[c.id]) != (it != keyOf.end()))
+         {
+            cerr << "contains(" << c.id << ") wrong at command " << i << endl;
+            return 1;
+         }
+         bool byId = i % 2 == 0;
+         if (c.type == 'd' && byId)
+            queue.decreaseKey(c.id, c.key);
+         else if (c.type == 'd')
+            queue.decreaseKey(handles[c.id], c.key);
+         else if (c.type == 'i' && byId)
+            queue.increaseKey(c.id, c.key);
+         else if (c.type == 'i')
+            queue.increaseKey(handles[c.id], c.key);
+         else if (byId)
+            queue.updateKey(c.id, c.key);
+         else
+            queue.updateKey(handles[c.id], c.key);
+         if (it != keyOf.end() && (c.type == 'u' || (c.type == 'd'
+                                     ? c.key < it->second : c.key > it->second)))
+         {
+            model.erase(make_pair(it->second, c.id));
+            model.insert(make_pair(c.key, c.id));
+            it->second = c.key;
+         }
+      }
+      else
+      {
+         string id = queue.extractMin();
+         map<string,int>::iterator it = keyOf.find(id);
+         if (it == keyOf.end() || it->second != model.begin()->first)
+         {
+            cerr << "extractMin returned " << id << " at command " << i
+                 << ", smallest key is " << model.begin()->first << endl;
+            return 1;
+         }
+         model.erase(make_pair(it->second, id));
+         keyOf.erase(it);
+         extracts++;
+      }
+      if (queue.size() != model.size())
+      {
+         cerr << "size " << queue.size() << " instead of " << model.size()
+              << " at command " << i << endl;
+         return 1;
+      }
+   }
+   cout << "ok: " << stream.size() << " commands, " << extracts
+        << " extracts, arity " << Arity << endl;
+   return 0;
+}
+
+/*
+ * Desc: Prints a stream in the command syntax of main.cpp.
+ *
+ */
+
+void generate(const vector<Command>& stream)
+{
+   for (size_t i = 0; i < stream.size(); i++)
+   {
+      const Command& c = stream[i];
+      if (c.type == 'x')
+         cout << "x\n";
+      else if (c.type == 'e')
+         cout << "e " << c.id << '\n';
+      else
+         cout << c.type << ' ' << c.id << ' ' << c.key << '\n';
+   }
+   cout << "q" << endl;
+}
+
+/*
+ * Desc: Prints a stream of runs of 1 .. 64 adds and 1 .. 64 extracts with
+ *       many equal keys, the id of an element being "key_serial".
+ *
+ * In:   size_t - number of commands, uint64_t - seed
+ */
+
+void generateTies(size_t count, uint64_t seed)
+{
+   mt19937_64 random(seed);
+   size_t serial = 0;
+   while (serial < count)
+   {
+      size_t adds = 1 + random() % 64;
+      for (size_t i = 0; i < adds; i++, serial++)
+      {
+         int key = (int)(random() % 6);
+         cout << "a " << key << '_' << serial << ' ' << key << '\n';
+      }
+      size_t extracts = 1 + random() % 64;
+      for (size_t i = 0; i < extracts; i++)
+         cout << "x\n";
+   }
+   cout << "q" << endl;
+}
+
+/*
+ * Desc: Mean ns per operation at growing queue sizes. At each size the
+ *       queue is filled with random keys, then ops pairs of extract and
+ *       insert keep the size steady while being timed.
+ *
+ * In:   Integer - largest size as a power of two, size_t - ops per size
+ *
+ */
+
+void benchmark(int maxLog, size_t ops)
+{
+   mt19937_64 random(1);
+   cout << "size,log2_size,insert_ns,extract_ns,decrease_ns" << endl;
+   for (int lg = 10; lg <= maxLog; lg += 2)
+   {
+      size_t n = (size_t)1 << lg;
+      MinPriorityQ<> queue;
+      vector<string> ids(n + ops);
+      for (size_t i = 0; i < ids.size(); i++)
+         ids[i] = "v" + to_string(i);
+      for (size_t i = 0; i < n; i++)
+         queue.insert(ids[i], (int)(random() % 1000000000));
+
+      double insertNs = 0, extractNs = 0;
+      for (size_t i = 0; i < ops; i++)
+      {
+         Clock::time_point t0 = Clock::now();
+         string id = queue.extractMin();
+         Clock::time_point t1 = Clock::now();
+         queue.insert(ids[n + i], (int)(random() % 1000000000));
+         Clock::time_point t2 = Clock::now();
+         extractNs += std::chrono::duration<double,std::nano>(t1-t0).count();
+         insertNs += std::chrono::duration<double,std::nano>(t2-t1).count();
+      }
+
+      size_t decreases = std::max((size_t)8, ((size_t)1 << 22) / n);
+      Clock::time_point t0 = Clock::now();
+      for (size_t i = 0; i < decreases; i++)
+         queue.decreaseKey(ids[n + ops - 1 - i % ops], -(int)i);
+      double decreaseNs = std::chrono::duration<double,std::nano>(
+                              Clock::now() - t0).count();
+
+      cout << n << "," << lg << "," << insertNs / ops << ","
+           << extractNs / ops << "," << decreaseNs / decreases << endl;
+   }
+}
+
+/*
+ * Desc: Times one heap arity on integer ids and keys: the bulk build of n
+ *       random keys, then ops pairs of extract and insert at size n.
+ *
+ * In:   size_t - size, size_t - ops, uint64_t - seed
+ *
+ */
+
+template <size_t Arity>
+void benchArity(size_t n, size_t ops, uint64_t seed)
+{
+   typedef MinPriorityQ<uint32_t,uint32_t,std::less<uint32_t>,Arity> Queue;
+   mt19937_64 random(seed);
+   vector<pair<uint32_t,uint32_t> > entries(n);
+   for (size_t i = 0; i < n; i++)
+      entries[i] = make_pair((uint32_t)i, (uint32_t)random());
+
+   Queue queue;
+   Clock::time_point t0 = Clock::now();
+   queue.bulkInsert(entries.begin(), entries.end());
+   Clock::time_point t1 = Clock::now();
+   vector<pair<uint32_t,uint32_t> >().swap(entries);
+
+   uint32_t checksum = 0;
+   for (size_t i = 0; i < ops; i++)
+   {
+      checksum += queue.extractMin();
+      queue.insert((uint32_t)(n + i), (uint32_t)random());
+   }
+   Clock::time_point t2 = Clock::now();
+
+   cout << Arity << "," << n << ","
+        << std::chrono::duration<double,std::nano>(t1-t0).count() / n << ","
+        << std::chrono::duration<double,std::nano>(t2-t1).count() / ops << ","
+        << checksum << endl;
+}
+
+/*
+ * Desc: Compares the binary heap with the 4-ary and 8-ary ones at sizes
+ *       10^4 .. 10^maxExp.
+ *
+ */
+
+void benchArities(int maxExp, size_t ops)
+{
+   cout << "arity,size,build_ns_per_element,extract_insert_ns,checksum"
+        << endl;
+   size_t n = 10000;
+   for (int e = 4; e <= maxExp; e++, n *= 10)
+   {
+      benchArity<2>(n, ops, e);
+      benchArity<4>(n, ops, e);
+      benchArity<8>(n, ops, e);
+   }
+}
+
+/*
+ * Desc: One MinPriorityQ behind a mutex, the way threads shared the queue
+ *       before MultiQueue. Same interface as MultiQueue for benchMulti.
+ *
+ */
+
+class LockedQueue
+{
+public:
+   bool insert(uint32_t, uint32_t);   //Adds under the lock
+   bool extractMin(uint32_t&);        //Removes under the lock
+private:
+   std::mutex lock;
+   MinPriorityQ<uint32_t,uint32_t> heap;
+};
+
+bool LockedQueue::insert(uint32_t id, uint32_t key)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   heap.insert(id, key);
+   return true;
+}
+
+bool LockedQueue::extractMin(uint32_t& id)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   if (heap.empty())
+      return false;
+   id = heap.extractMin();
+   return true;
+}
+
+/*
+ * Desc: Times threads threads each doing ops pairs of extract and insert
+ *       on a queue prefilled with 2^16 elements per thread.
+ *
+ * In:   Queue - MultiQueue or LockedQueue, size_t - threads, size_t - ops
+ * Out:  double - ns per pair, wall time over all pairs of all threads
+ */
+
+template <typename Queue>
+double timeThreads(Queue& queue, size_t threads, size_t ops)
+{
+   size_t fill = threads << 16;
+   mt19937_64 random(threads);
+   for (size_t i = 0; i < fill; i++)
+      queue.insert((uint32_t)i, (uint32_t)random());
+
+   vector<std::thread> workers;
+   Clock::time_point t0 = Clock::now();
+   for (size_t t = 0; t < threads; t++)
+   {
+      workers.push_back(std::thread([&queue, t, ops]()
+      {
+         mt19937_64 keys(t + 1);
+         uint32_t id;
+         for (size_t i = 0; i < ops; i++)
+         {
+            if (queue.extractMin(id))
+               queue.insert(id, (uint32_t)keys());
+         }
+      }));
+   }
+   for (size_t t = 0; t < workers.size(); t++)
+      workers[t].join();
+   return std::chrono::duration<double,std::nano>(Clock::now() - t0).count()
+          / (threads * ops);
+}
+
+/*
+ * Desc: Throughput of MultiQueue against one locked MinPriorityQ at 1, 2,
+ *       4 .. maxThreads threads, then the rank error of MultiQueue.
+ *
+ */
+
+void benchMulti(size_t maxThreads, size_t ops)
+{
+   cout << "queue,threads,ns_per_pair" << endl;
+   for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+   {
+      LockedQueue locked;
+      cout << "locked," << threads << ","
+           << timeThreads(locked, threads, ops) << endl;
+      MultiQueue<uint32_t,uint32_t> multi(threads);
+      cout << "multi," << threads << ","
+           << timeThreads(multi, threads, ops) << endl;
+   }
+
+   cout << "threads,heaps,mean_rank_error,max_rank_error" << endl;
+   size_t n = (size_t)1 << 17;
+   for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+   {
+      MultiQueue<uint32_t,uint32_t> multi(threads);
+      vector<uint32_t> keys(n);
+      for (size_t i = 0; i < n; i++)
+         keys[i] = (uint32_t)i;
+      std::shuffle(keys.begin(), keys.end(), mt19937_64(threads));
+      for (size_t i = 0; i < n; i++)
+         multi.insert(keys[i], keys[i]);        //The id is its key
+
+      vector<uint32_t> tree(n + 1, 0);          //Fenwick tree of queued keys
+      for (size_t i = 1; i <= n; i++)
+      {
+         tree[i]++;
+         if (i + (i & -i) <= n)
+            tree[i + (i & -i)] += tree[i];
+      }
+      double sum = 0;
+      uint32_t worst = 0, key;
+      while (multi.extractMin(key))
+      {
+         uint32_t rank = 0;                     //Queued keys below key
+         for (size_t i = key; i > 0; i -= i & -i)
+            rank += tree[i];
+         for (size_t i = key + 1; i <= n; i += i & -i)
+            tree[i]--;
+         sum += rank;
+         worst = std::max(worst, rank);
+      }
+      cout << threads << "," << 2 * threads << "," << sum / n << ","
+           << worst << endl;
+   }
+}
+
+/*
+ * Desc: Runs threads threads of ops extract/insert pairs on a queue filled
+ *       with 1024 ids per thread and keys below 2^16, timing every pair.
+ *       An id goes back with its old key plus up to 1023, wrapping at 2^16,
+ *       so keys climb the way they do in a Dijkstra or event simulation,
+ *       the use bucket queues are made for. Then drains the queue and
+ *       checks that every id is still there exactly once.
+ *
+ * In:   string - name of the queue, Queue - BucketQueue or LockedQueue,
+ *       size_t - threads, size_t - ops per thread
+ * Out:  Integer - 0 when no id was lost or duplicated
+ */
+
+template <typename Queue>
+int stressThreads(const string& name, Queue& queue, size_t threads, size_t ops)
+{
+   const uint32_t KEYS = 1 << 16;
+   size_t fill = threads * 1024;
+   mt19937_64 random(threads);
+   vector<uint32_t> keyOf(fill);     //Written only by the thread holding id
+   for (size_t i = 0; i < fill; i++)
+   {
+      keyOf[i] = (uint32_t)(random() % 1024);
+      queue.insert((uint32_t)i, keyOf[i]);
+   }
+
+   vector<vector<float> > latency(threads, vector<float>(ops));
+   vector<std::thread> workers;
+   std::atomic<size_t> failed(0);
+   Clock::time_point t0 = Clock::now();
+   for (size_t t = 0; t < threads; t++)
+   {
+      workers.push_back(std::thread([&, t]()
+      {
+         mt19937_64 steps(t + 1);
+         uint32_t id;
+         for (size_t i = 0; i < ops; i++)
+         {
+            Clock::time_point start = Clock::now();
+            if (queue.extractMin(id))
+            {
+               keyOf[id] = (uint32_t)((keyOf[id] + steps() % 1024) % KEYS);
+               if (!queue.insert(id, keyOf[id]))
+                  failed++;
+            }
+            latency[t][i] = std::chrono::duration<float,std::nano>(
+                               Clock::now() - start).count();
+         }
+      }));
+   }
+   for (size_t t = 0; t < workers.size(); t++)
+      workers[t].join();
+   double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+   vector<char> seen(fill, 0);
+   uint32_t id;
+   size_t found = 0;
+   while (queue.extractMin(id))
+   {
+      if (id >= fill || seen[id]++)
+         failed++;
+      found++;
+   }
+   if (failed != 0 || found != fill)
+   {
+      cerr << name << " at " << threads << " threads: " << found << " of "
+           << fill << " ids, " << failed << " lost or duplicated" << endl;
+      return 1;
+   }
+
+   vector<float> all;
+   for (size_t t = 0; t < threads; t++)
+      all.insert(all.end(), latency[t].begin(), latency[t].end());
+   std::sort(all.begin(), all.end());
+   cout << name << "," << threads << "," << (uint64_t)(2 * all.size() / seconds)
+        << "," << all[all.size() / 2] << "," << all[all.size() * 99 / 100]
+        << "," << all[all.size() * 999 / 1000] << endl;
+   return 0;
+}
+
+/*
+ * Desc: BucketQueue against the locked MinPriorityQ at 1, 2, 4 ..
+ *       maxThreads threads.
+ *
+ * Out:  Integer - 0 when every stress run kept its ids
+ */
+
+int benchLockFree(size_t maxThreads, size_t ops)
+{
+   cout << "queue,threads,ops_per_s,p50_ns,p99_ns,p999_ns" << endl;
+   for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+   {
+      LockedQueue locked;
+      BucketQueue<uint32_t> bucket(1 << 16, threads * 1024);
+      if (stressThreads("locked", locked, threads, ops)
+          || stressThreads("lockfree", bucket, threads, ops))
+         return 1;
+   }
+   return 0;
+}
+
+/*
+ * Desc: Inserts n elements with keys below distinct, the id being the
+ *       insertion index, then drains the queue. A stable queue must hand
+ *       out the ids of equal keys in increasing order.
+ *
+ * In:   string - name of the queue, Queue - MinPriorityQ<uint32_t,int> or
+ *       StableMinPriorityQ<uint32_t>, size_t - n, size_t - distinct keys,
+ *       boolean - whether to check the FIFO order
+ * Out:  Integer - 0 when the order was right
+ */
+
+template <typename Queue>
+int timeDuplicates(const string& name, Queue& queue, size_t n,
+                   size_t distinct, bool fifo)
+{
+   mt19937_64 random(distinct);
+   vector<int> keys(n);
+   for (size_t i = 0; i < n; i++)
+      keys[i] = (int)(random() % distinct);
+
+   Clock::time_point t0 = Clock::now();
+   for (size_t i = 0; i < n; i++)
+      queue.insert((uint32_t)i, keys[i]);
+   Clock::time_point t1 = Clock::now();
+   int lastKey = INT_MIN;
+   uint32_t lastId = 0;
+   for (size_t i = 0; i < n; i++)
+   {
+      int key = queue.minKey();
+      uint32_t id = queue.extractMin();
+      if (key < lastKey || keys[id] != key
+          || (fifo && key == lastKey && id < lastId))
+      {
+         cerr << name << ": id " << id << " key " << key << " after id "
+              << lastId << " key " << lastKey << endl;
+         return 1;
+      }
+      lastKey = key;
+      lastId = id;
+   }
+   Clock::time_point t2 = Clock::now();
+   cout << name << "," << n << "," << distinct << ","
+        << std::chrono::duration<double,std::nano>(t1-t0).count() / n << ","
+        << std::chrono::duration<double,std::nano>(t2-t1).count() / n << endl;
+   return 0;
+}
+
+/*
+ * Desc: MinPriorityQ against StableMinPriorityQ from all keys equal to all
+ *       keys distinct.
+ *
+ * Out:  Integer - 0 when every drain was in order
+ */
+
+int benchDuplicates(size_t n)
+{
+   cout << "queue,elements,distinct_keys,insert_ns,extract_ns" << endl;
+   size_t distinct[] = { 1, 16, 1024, n };
+   for (size_t d = 0; d < 4; d++)
+   {
+      MinPriorityQ<uint32_t,int> plain;
+      StableMinPriorityQ<uint32_t> stable;
+      if (timeDuplicates("plain", plain, n, distinct[d], false)
+          || timeDuplicates("stable", stable, n, distinct[d], true))
+         return 1;
+   }
+   return 0;
+}
+
+/*
+ * Desc: Fills a queue with n random keys and drains it, checking that the
+ *       keys come out in order.
+ *
+ * In:   string - name of the queue, Queue - ExternalQ or MinPriorityQ,
+ *       size_t - n, uint64_t - seed
+ * Out:  Integer - 0 when the order was right
+ */
+
+template <typename Queue>
+int fillAndDrain(const string& name, Queue& queue, size_t n, uint64_t seed)
+{
+   mt19937_64 random(seed);
+   Clock::time_point t0 = Clock::now();
+   for (size_t i = 0; i < n; i++)
+      queue.insert((uint32_t)i, random());
+   Clock::time_point t1 = Clock::now();
+   size_t runs = queue.runs();
+   uint64_t last = 0;
+   for (size_t i = 0; i < n; i++)
+   {
+      uint64_t key = queue.minKey();
+      queue.extractMin();
+      if (key < last || (i + 1 == n) != queue.empty())
+      {
+         cerr << name << ": key " << key << " after " << last
+              << " at extract " << i << endl;
+         return 1;
+      }
+      last = key;
+   }
+   Clock::time_point t2 = Clock::now();
+   cout << name << "," << n << "," << runs << ","
+        << std::chrono::duration<double,std::nano>(t1-t0).count() / n << ","
+        << std::chrono::duration<double,std::nano>(t2-t1).count() / n << endl;
+   return 0;
+}
+
+/*
+ * Desc: Wraps MinPriorityQ for fillAndDrain, it never has runs on disk.
+ *
+ */
+
+class MemoryQueue : public MinPriorityQ<uint32_t,uint64_t>
+{
+public:
+   size_t runs() const { return 0; }
+};
+
+/*
+ * Desc: ExternalQ against the in-memory MinPriorityQ on n elements.
+ *
+ * Out:  Integer - 0 when both drained in order
+ */
+
+int benchExternal(size_t n, size_t spill, const string& dir)
+{
+   cout << "queue,elements,runs,insert_ns,extract_ns" << endl;
+   MemoryQueue memory;
+   if (fillAndDrain("memory", memory, n, 1))
+      return 1;
+   ExternalQ<uint32_t,uint64_t> external(spill, dir);
+   return fillAndDrain("external", external, n, 1);
+}
+
+/*
+ * Desc: Delay of a new timer or event from now, at least 1.
+ *
+ */
+
+uint64_t delay(mt19937_64& random, bool timers)
+{
+   if (timers)
+      return 1 + random() % 65536;
+   uint64_t bits = random() % 40;
+   return 1 + random() % (1ull << bits);
+}
+
+/*
+ * Desc: Times ops steps of a monotone workload on a queue of n elements.
+ *       A step extracts the minimum, which becomes the time now, and
+ *       schedules the same id again after a delay. The timer workload also
+ *       re-arms a random pending timer every fourth step. Every extracted
+ *       key must be the last key given to its id and not below now.
+ *
+ * In:   string - name of the queue, boolean - timer or simulation
+ *       size_t - n, size_t - ops, uint64_t - seed
+ * Out:  Integer - 0 when the order was right
+ */
+
+template <typename Queue>
+int timeMonotone(const string& name, bool timers, size_t n, size_t ops,
+                 uint64_t seed)
+{
+   Queue queue;
+   mt19937_64 random(seed);
+   vector<uint64_t> keyOf(n);
+   vector<typename Queue::Handle> handles(n);
+   for (size_t i = 0; i < n; i++)
+   {
+      keyOf[i] = delay(random, timers);
+      handles[i] = queue.insert((uint32_t)i, keyOf[i]);
+   }
+   uint64_t now = 0;
+   Clock::time_point t0 = Clock::now();
+   for (size_t s = 0; s < ops; s++)
+   {
+      uint64_t key = queue.minKey();
+      uint32_t id = queue.extractMin();
+      if (key < now || key != keyOf[id])
+      {
+         cerr << name << ": id " << id << " key " << key << " at time "
+              << now << endl;
+         return 1;
+      }
+      now = key;
+      keyOf[id] = now + delay(random, timers);
+      handles[id] = queue.insert(id, keyOf[id]);
+      if (timers && s % 4 == 0)
+      {
+         uint32_t other = (uint32_t)(random() % n);
+         keyOf[other] = now + delay(random, timers);
+         queue.updateKey(handles[other], keyOf[other]);
+      }
+   }
+   Clock::time_point t1 = Clock::now();
+   cout << (timers ? "timer," : "simulation,") << name << "," << n << ","
+        << std::chrono::duration<double,std::nano>(t1-t0).count() / ops
+        << endl;
+   return 0;
+}
+
+/*
+ * Desc: RadixHeap against the binary and 4-ary heap on both workloads.
+ *
+ * Out:  Integer - 0 when every queue kept the order
+ */
+
+int benchRadix(int maxLog, size_t ops)
+{
+   cout << "workload,queue,elements,step_ns" << endl;
+   for (int w = 0; w < 2; w++)
+   {
+      bool timers = w == 0;
+      for (int lg = 10; lg <= maxLog; lg += 2)
+      {
+         size_t n = (size_t)1 << lg;
+         if (timeMonotone<MinPriorityQ<uint32_t,uint64_t> >("binary", timers,
+                                                           n, ops, lg)
+             || timeMonotone<MinPriorityQ<uint32_t,uint64_t,
+                                          std::less<uint64_t>,4> >
+                   ("4-ary", timers, n, ops, lg)
+             || timeMonotone<RadixHeap<uint32_t,uint64_t> >("radix", timers,
+                                                          n, ops, lg))
+            return 1;
+      }
+   }
+   return 0;
+}
+
+/*
+ * Desc: Parses the options and runs the chosen mode.
+ *
+ */
+
+int main(int argc, char* argv[])
+{
+   string mode = "bench";
+   size_t count = 1000000;
+   uint64_t seed = 1;
+   int maxLog = -1;                  //Default depends on the mode
+   size_t ops = 100000;
+   size_t threads = 0;               //Default depends on the mode
+   size_t spill = 0;                 //Default depends on -n
+   string dir = "/tmp";
+   for (int i = 1; i < argc; i++)
+   {
+      string arg = argv[i];
+      if (arg == "-check" || arg == "-gen" || arg == "-ties" || arg == "-arity"
+          || arg == "-multi" || arg == "-lockfree" || arg == "-external"
+          || arg == "-dup" || arg == "-radix")
+         mode = arg.substr(1);
+      else if (arg == "-n" && i + 1 < argc)
+         count = strtoull(argv[++i], NULL, 10);
+      else if (arg == "-s" && i + 1 < argc)
+         seed = strtoull(argv[++i], NULL, 10);
+      else if (arg == "-m" && i + 1 < argc)
+         maxLog = atoi(argv[++i]);
+      else if (arg == "-k" && i + 1 < argc)
+         ops = strtoull(argv[++i], NULL, 10);
+      else if (arg == "-t" && i + 1 < argc)
+         threads = strtoull(argv[++i], NULL, 10);
+      else if (arg == "-spill" && i + 1 < argc)
+         spill = strtoull(argv[++i], NULL, 10);
+      else if (arg == "-dir" && i + 1 < argc)
+         dir = argv[++i];
+      else
+      {
+         cerr << "usage: pqbench [-check|-gen|-ties|-arity|-multi|-lockfree"
+                 "|-external|-dup|-radix] [-n ops] [-s seed] [-m maxlog] [-k ops]"
+                 " [-t threads] [-spill elements] [-dir path]" << endl;
+         return 2;
+      }
+   }
+
+   if (mode == "check")
+   {
+      vector<Command> stream = makeStream(count, seed);
+      return check<2>(stream) || check<4>(stream) || check<8>(stream);
+   }
+   if (mode == "arity")
+      benchArities(maxLog < 0 ? 7 : maxLog, ops);
+   else if (mode == "multi")
+      benchMulti(threads != 0 ? threads
+                 : std::max(1u, std::thread::hardware_concurrency()), ops);
+   else if (mode == "dup")
+      return benchDuplicates(count);
+   else if (mode == "external")
+      return benchExternal(count, spill != 0 ? spill : count / 16 + 1, dir);
+   else if (mode == "radix")
+      return benchRadix(maxLog < 0 ? 20 : maxLog, ops);
+   else if (mode == "lockfree")
+      return benchLockFree(threads != 0 ? threads : 64, ops);
+   else if (mode == "gen")
+      generate(makeStream(count, seed));
+   else if (mode == "ties")
+      generateTies(count, seed);
+   else
+      benchmark(maxLog < 0 ? 20 : maxLog, ops);
+   return 0;
+}
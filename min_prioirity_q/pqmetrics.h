@@ -0,0 +1,201 @@
+/**
+ *  @file: pqmetrics.h
+ *  @desc: Optional instrumentation of MinPriorityQ, compiled in with
+ *         -DMPQ_METRICS. Counts every operation, the key comparisons and
+ *         the levels each sift moved, tracks the peak size and keeps a
+ *         histogram of the latency of every operation in power of two ns
+ *         buckets. MinPriorityQ::metrics() hands the numbers out and
+ *         report() prints them.
+ *
+ *         Without MPQ_METRICS the class does not exist and the hooks below
+ *         expand to nothing, the queue then has no member, no clock read
+ *         and no counter more than before. Every translation unit of a
+ *         program must agree on the flag.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____pqmetrics__
+#define ____pqmetrics__
+
+#ifdef MPQ_METRICS
+
+#include <chrono>
+#include <ostream>
+#include <cstddef>
+#include <stdint.h>
+
+class PQMetrics
+{
+public:
+   enum Op { INSERT, BULK, DECREASE, INCREASE, UPDATE, EXTRACT, REPLACE,
+             ERASE, MELD, OPS };
+   static const size_t BUCKETS = 40;      //Bucket b: below 2^b ns
+
+   class Timer                  //Times one operation while in scope
+   {
+   public:
+      Timer(PQMetrics&,Op);     //Starts the clock
+      ~Timer();                 //Records the operation
+   private:
+      PQMetrics& metrics;
+      Op op;
+      std::chrono::steady_clock::time_point start;
+   };
+
+   PQMetrics();                 //Constructor, all zero
+   void reset();                //Sets everything back to zero
+   void endSift();              //Closes the sift whose levels were counted
+   void grew(size_t);           //Raises the peak size to a size
+   void report(std::ostream&) const; //Prints the numbers as CSV
+
+   uint64_t count[OPS];         //Operations of each kind
+   uint64_t latency[OPS][BUCKETS]; //Latency histogram of each kind
+   uint64_t nanoseconds[OPS];   //Total time spent in each kind
+   uint64_t comparisons;        //Key comparisons
+   uint64_t sifts;              //Sifts up or down which moved an element
+   uint64_t siftLevels;         //Levels moved over all sifts
+   uint64_t deepestSift;        //Most levels moved by one sift
+   uint64_t depth;              //Levels of the sift in progress
+   size_t peakSize;             //Most elements queued at once
+
+private:
+   static const char* name(size_t); //Name of an operation
+   uint64_t percentile(size_t,double) const; //Bucket bound of a quantile
+};
+
+/**
+ * Desc: Timer constructor, starts the clock of one operation.
+ *
+ */
+
+inline PQMetrics::Timer::Timer(PQMetrics& owner, Op kind)
+   : metrics(owner), op(kind), start(std::chrono::steady_clock::now())
+{
+
+}
+
+/**
+ * Desc: Counts the operation and files its latency under the first power
+ *       of two above it.
+ *
+ */
+
+inline PQMetrics::Timer::~Timer()
+{
+   uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+   size_t b = 0;
+   while (b + 1 < BUCKETS && (ns >> b) != 0)
+      b++;
+   metrics.count[op]++;
+   metrics.nanoseconds[op] += ns;
+   metrics.latency[op][b]++;
+}
+
+inline PQMetrics::PQMetrics()
+{
+   reset();
+}
+
+inline void PQMetrics::reset()
+{
+   for (size_t op = 0; op < OPS; op++)
+   {
+      count[op] = 0;
+      nanoseconds[op] = 0;
+      for (size_t b = 0; b < BUCKETS; b++)
+         latency[op][b] = 0;
+   }
+   comparisons = sifts = siftLevels = deepestSift = depth = 0;
+   peakSize = 0;
+}
+
+/**
+ * Desc: Ends a sift. A sift that moved no element is not counted.
+ *
+ */
+
+inline void PQMetrics::endSift()
+{
+   if (depth == 0)
+      return;
+   sifts++;
+   siftLevels += depth;
+   if (depth > deepestSift)
+      deepestSift = depth;
+   depth = 0;
+}
+
+inline void PQMetrics::grew(size_t size)
+{
+   if (size > peakSize)
+      peakSize = size;
+}
+
+/**
+ * Desc: Prints the totals, then one line per operation kind that was used
+ *       with its count, mean ns and the bounds of the buckets holding the
+ *       50th and 99th percentile.
+ *
+ */
+
+inline void PQMetrics::report(std::ostream& out) const
+{
+   out << "comparisons," << comparisons << "\n"
+       << "sifts," << sifts << "\n"
+       << "sift_levels," << siftLevels << "\n"
+       << "deepest_sift," << deepestSift << "\n"
+       << "peak_size," << peakSize << "\n"
+       << "op,count,mean_ns,p50_below_ns,p99_below_ns\n";
+   for (size_t op = 0; op < OPS; op++)
+   {
+      if (count[op] == 0)
+         continue;
+      out << name(op) << "," << count[op] << ","
+          << nanoseconds[op] / count[op] << "," << percentile(op, 0.5)
+          << "," << percentile(op, 0.99) << "\n";
+   }
+   out.flush();
+}
+
+inline const char* PQMetrics::name(size_t op)
+{
+   static const char* names[OPS] = { "insert", "bulkInsert", "decreaseKey",
+                                     "increaseKey", "updateKey",
+                                     "extractMin", "replaceMin", "erase",
+                                     "meld" };
+   return names[op];
+}
+
+inline uint64_t PQMetrics::percentile(size_t op, double quantile) const
+{
+   uint64_t wanted = (uint64_t)(quantile * count[op]);
+   uint64_t seen = 0;
+   size_t b = 0;
+   for (; b + 1 < BUCKETS; b++)
+   {
+      seen += latency[op][b];
+      if (seen > wanted)
+         break;
+   }
+   return (uint64_t)1 << b;
+}
+
+#define MPQ_OP(op) PQMetrics::Timer mpqTimer(metricsData, PQMetrics::op)
+#define MPQ_COUNT(counter) (++metricsData.counter)
+#define MPQ_SIFTED() (metricsData.endSift())
+#define MPQ_GREW(size) (metricsData.grew(size))
+
+#else
+
+#define MPQ_OP(op)
+#define MPQ_COUNT(counter) ((void)0)
+#define MPQ_SIFTED() ((void)0)
+#define MPQ_GREW(size) ((void)0)
+
+#endif /* MPQ_METRICS */
+
+#endif /* defined(____pqmetrics__) */
@@ -0,0 +1,507 @@
+/**
+ * @file: pqsuite.cpp
+ * @desc: Benchmark suite of the priority queue backends. Reproducible
+ *        workload generators write a trace of operations, and every
+ *        backend replays the same trace:
+ *
+ *           random      n inserts of random keys, then n extracts
+ *           dijkstra    Dijkstra on a random graph of n nodes and degree 4,
+ *                       inserts, decreaseKeys and extracts as they come
+ *           timers      n timers, then 2n steps which fire the earliest
+ *                       timer and set it again, every fourth step also
+ *                       re-arms a random pending timer with updateKey
+ *           duplicates  n inserts of keys taking only 16 values, drained
+ *           ascending   n inserts of increasing keys, drained
+ *           descending  n inserts of decreasing keys, drained, every
+ *                       insert of a heap sifts up to the root
+ *
+ *        Backends: the binary, 4-ary and 8-ary MinPriorityQ, the RadixHeap,
+ *        on the workloads which never raise a key the PairingHeap, and on
+ *        the workloads without key changes the ExternalQ. Every
+ *        workload extracts in nondecreasing order, so the monotone radix
+ *        heap applies to all of them. Keys are made distinct where ids
+ *        matter by putting the id in their low bits.
+ *
+ *        Peak memory is the most heap memory the backend held during the
+ *        replay, counted by wrappers of malloc and free. They need glibc,
+ *        elsewhere the peak kB column is left empty.
+ *        Prints CSV: workload, backend, elements, operations, ns per
+ *        operation and peak kB. An extract whose key differs from the
+ *        trace fails the run.
+ *
+ *        pqsuite [-n elements] [-s seed]
+ *
+ * @date: 04/22/2015
+ * @author: Diney Wankhede
+ *
+ */
+
+#include "minpriority.h"
+#include "radixheap.h"
+#include "externalq.h"
+#include "pairingheap.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <cerrno>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::set;
+using std::pair;
+using std::make_pair;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::mt19937_64;
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * Desc: One operation of a trace. For an extract the key is the one the
+ *       extracted element must have.
+ *
+ */
+
+class Op
+{
+public:
+   Op(char,uint32_t,uint64_t);  //Constructor
+   char type;                   //'a' insert, 'd' decrease, 'u' update, 'x'
+   uint32_t id;                 //Unused for 'x'
+   uint64_t key;
+};
+
+Op::Op(char new_type, uint32_t new_id, uint64_t new_key)
+   : type(new_type), id(new_id), key(new_key)
+{
+
+}
+
+/*
+ * Desc: A generated trace and what a backend needs to replay it.
+ *
+ */
+
+class Workload
+{
+public:
+   string name;
+   vector<Op> ops;
+   size_t ids;                  //Ids are below this
+   bool updates;                //Uses decreaseKey or updateKey
+   bool raises;                 //Uses updateKey
+};
+
+static const int ID_BITS = 24;  //Low key bits holding the id
+
+/*
+ * Desc: Appends n extracts, the expected keys being the given ones in
+ *       sorted order.
+ *
+ */
+
+void drain(Workload& w, vector<uint64_t> keys)
+{
+   std::sort(keys.begin(), keys.end());
+   for (size_t i = 0; i < keys.size(); i++)
+      w.ops.push_back(Op('x', 0, keys[i]));
+}
+
+/*
+ * Desc: n inserts of keys from a function of the index, then the drain.
+ *
+ */
+
+Workload fillAndDrain(const string& name, size_t n,
+                      std::function<uint64_t(size_t)> keyAt)
+{
+   Workload w;
+   w.name = name;
+   w.ids = n;
+   w.updates = false;
+   w.raises = false;
+   vector<uint64_t> keys(n);
+   for (size_t i = 0; i < n; i++)
+   {
+      keys[i] = keyAt(i);
+      w.ops.push_back(Op('a', (uint32_t)i, keys[i]));
+   }
+   drain(w, keys);
+   return w;
+}
+
+/*
+ * Desc: Dijkstra from node 0 on a random graph whose edges are drawn when
+ *       their node is settled. A std::set plays the queue.
+ *
+ */
+
+Workload dijkstra(size_t n, uint64_t seed)
+{
+   mt19937_64 random(seed);
+   Workload w;
+   w.name = "dijkstra";
+   w.ids = n;
+   w.updates = true;
+   w.raises = false;
+   vector<uint64_t> key(n, 0);          //Latest key of a queued node
+   vector<bool> queued(n, false);       //Reached, settled or not
+   vector<bool> settled(n, false);
+   set<uint64_t> queue;
+   queued[0] = true;                    //Distance 0, id 0
+   w.ops.push_back(Op('a', 0, 0));
+   queue.insert(0);
+   while (!queue.empty())
+   {
+      uint64_t top = *queue.begin();
+      queue.erase(queue.begin());
+      w.ops.push_back(Op('x', 0, top));
+      uint32_t u = (uint32_t)(top & ((1u << ID_BITS) - 1));
+      uint64_t distance = top >> ID_BITS;
+      settled[u] = true;
+      for (int e = 0; e < 4; e++)
+      {
+         uint32_t v = (uint32_t)(random() % n);
+         uint64_t through = (distance + 1 + random() % 1000) << ID_BITS | v;
+         if (settled[v] || (queued[v] && key[v] <= through))
+            continue;
+         if (!queued[v])
+            w.ops.push_back(Op('a', v, through));
+         else
+         {
+            queue.erase(key[v]);
+            w.ops.push_back(Op('d', v, through));
+         }
+         key[v] = through;
+         queued[v] = true;
+         queue.insert(through);
+      }
+   }
+   return w;
+}
+
+/*
+ * Desc: Timer queue of n timers set up to 2^16 ticks ahead. A std::set
+ *       plays the queue.
+ *
+ */
+
+Workload timers(size_t n, uint64_t seed)
+{
+   mt19937_64 random(seed);
+   Workload w;
+   w.name = "timers";
+   w.ids = n;
+   w.updates = true;
+   w.raises = true;
+   vector<uint64_t> key(n);
+   set<uint64_t> queue;
+   for (size_t i = 0; i < n; i++)
+   {
+      key[i] = (1 + random() % 65536) << ID_BITS | i;
+      w.ops.push_back(Op('a', (uint32_t)i, key[i]));
+      queue.insert(key[i]);
+   }
+   for (size_t s = 0; s < 2 * n; s++)
+   {
+      uint64_t top = *queue.begin();
+      queue.erase(queue.begin());
+      w.ops.push_back(Op('x', 0, top));
+      uint64_t now = top >> ID_BITS;
+      uint32_t id = (uint32_t)(top & ((1u << ID_BITS) - 1));
+      key[id] = (now + 1 + random() % 65536) << ID_BITS | id;
+      w.ops.push_back(Op('a', id, key[id]));
+      queue.insert(key[id]);
+      if (s % 4 == 0)
+      {
+         uint32_t other = (uint32_t)(random() % n);
+         queue.erase(key[other]);
+         key[other] = (now + 1 + random() % 65536) << ID_BITS | other;
+         w.ops.push_back(Op('u', other, key[other]));
+         queue.insert(key[other]);
+      }
+   }
+   return w;
+}
+
+/*
+ * Desc: ExternalQ with the handle interface the replay uses. It has no key
+ *       changes, workloads with updates are not run on it.
+ *
+ */
+
+class ExternalBackend : public ExternalQ<uint32_t,uint64_t>
+{
+public:
+   class Handle
+   {
+   };
+   explicit ExternalBackend(size_t spill)
+      : ExternalQ<uint32_t,uint64_t>(spill) { }
+   Handle insert(uint32_t id, uint64_t key)
+   {
+      ExternalQ<uint32_t,uint64_t>::insert(id, key);
+      return Handle();
+   }
+   void decreaseKey(Handle, uint64_t) { }
+   void updateKey(Handle, uint64_t) { }
+};
+
+/*
+ * Desc: PairingHeap with the handle interface the replay uses. It only
+ *       lowers keys, workloads which raise them are not run on it.
+ *
+ */
+
+class PairingBackend : public PairingHeap<uint32_t,uint64_t>
+{
+public:
+   void updateKey(Handle, uint64_t) { }
+};
+
+/*
+ * Desc: Bytes the program holds from malloc, now and at most since the
+ *       last resetPeak. malloc and its relatives are replaced by wrappers
+ *       around glibc's own which add or subtract the usable size of every
+ *       block, operator new and the AlignedAllocator of the heaps both end
+ *       up here. The figures only depend on what is allocated, not on how
+ *       glibc lays out its heap, so a run is measured the same wherever it
+ *       comes in the suite. Without glibc nothing is counted.
+ *
+ */
+
+static size_t heldBytes = 0;
+static size_t peakBytes = 0;
+
+#ifdef __GLIBC__
+static const bool COUNTED = true;
+
+extern "C"
+{
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t,size_t);
+void* __libc_realloc(void*,size_t);
+void* __libc_memalign(size_t,size_t);
+void __libc_free(void*);
+}
+
+void* counted(void* block)
+{
+   if (block != NULL)
+   {
+      heldBytes += malloc_usable_size(block);
+      if (heldBytes > peakBytes)
+         peakBytes = heldBytes;
+   }
+   return block;
+}
+
+void uncount(void* block)
+{
+   if (block != NULL)
+      heldBytes -= malloc_usable_size(block);
+}
+
+extern "C"
+{
+void* malloc(size_t size) noexcept
+{
+   return counted(__libc_malloc(size));
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+   return counted(__libc_calloc(count, size));
+}
+
+void* realloc(void* block, size_t size) noexcept
+{
+   uncount(block);
+   void* moved = __libc_realloc(block, size);
+   if (moved == NULL && size != 0)
+      return counted(block);                 //Failed, the old block stays
+   return counted(moved);
+}
+
+void* memalign(size_t align, size_t size) noexcept
+{
+   return counted(__libc_memalign(align, size));
+}
+
+void* aligned_alloc(size_t align, size_t size) noexcept
+{
+   return counted(__libc_memalign(align, size));
+}
+
+int posix_memalign(void** block, size_t align, size_t size) noexcept
+{
+   *block = counted(__libc_memalign(align, size));
+   return *block == NULL ? ENOMEM : 0;
+}
+
+void free(void* block) noexcept
+{
+   uncount(block);
+   __libc_free(block);
+}
+}
+#else
+static const bool COUNTED = false;
+#endif
+
+void resetPeak()
+{
+   peakBytes = heldBytes;
+}
+
+/*
+ * Desc: Replays a trace on an empty queue and prints its CSV line. Handles
+ *       and keys of the ids are set up before the memory baseline is taken,
+ *       the peak is what the queue held at most on top of it.
+ *
+ * In:   Workload - the trace, string - name of the backend, Queue - empty
+ * Out:  Integer - 0 when every extract matched the trace
+ */
+
+template <typename Queue>
+int replay(const Workload& w, const string& backend, Queue& queue)
+{
+   vector<uint64_t> keyOf(w.ids, 0);
+   vector<typename Queue::Handle> handles(w.ids);
+   resetPeak();
+   size_t baseline = heldBytes;
+   Clock::time_point t0 = Clock::now();
+   for (size_t i = 0; i < w.ops.size(); i++)
+   {
+      const Op& op = w.ops[i];
+      if (op.type == 'a')
+      {
+         keyOf[op.id] = op.key;
+         handles[op.id] = queue.insert(op.id, op.key);
+      }
+      else if (op.type == 'd')
+      {
+         keyOf[op.id] = op.key;
+         queue.decreaseKey(handles[op.id], op.key);
+      }
+      else if (op.type == 'u')
+      {
+         keyOf[op.id] = op.key;
+         queue.updateKey(handles[op.id], op.key);
+      }
+      else
+      {
+         uint32_t id = queue.extractMin();
+         if (keyOf[id] != op.key)
+         {
+            cerr << w.name << "," << backend << ": extract " << i
+                 << " gave key " << keyOf[id] << " instead of " << op.key
+                 << endl;
+            return 1;
+         }
+      }
+   }
+   Clock::time_point t1 = Clock::now();
+   cout << w.name << "," << backend << "," << w.ids << "," << w.ops.size()
+        << ","
+        << std::chrono::duration<double,std::nano>(t1-t0).count()
+           / w.ops.size()
+        << ",";
+   if (COUNTED)
+      cout << (peakBytes - baseline) / 1024;
+   cout << endl;
+   return 0;
+}
+
+/*
+ * Desc: Every backend on a trace, each on a queue of its own.
+ *
+ * Out:  Integer - 0 when all of them replayed it right
+ */
+
+int runAll(const Workload& w)
+{
+   int failed = 0;
+   {
+      MinPriorityQ<uint32_t,uint64_t> binary;
+      failed |= replay(w, "binary", binary);
+   }
+   {
+      MinPriorityQ<uint32_t,uint64_t,std::less<uint64_t>,4> quaternary;
+      failed |= replay(w, "4-ary", quaternary);
+   }
+   {
+      MinPriorityQ<uint32_t,uint64_t,std::less<uint64_t>,8> octonary;
+      failed |= replay(w, "8-ary", octonary);
+   }
+   {
+      RadixHeap<uint32_t,uint64_t> radix;
+      failed |= replay(w, "radix", radix);
+   }
+   if (!w.raises)
+   {
+      PairingBackend pairing;
+      failed |= replay(w, "pairing", pairing);
+   }
+   if (!w.updates)
+   {
+      ExternalBackend external(w.ids / 16 + 1);
+      failed |= replay(w, "external", external);
+   }
+   return failed;
+}
+
+/*
+ * Desc: Parses the options, generates the workloads one at a time and runs
+ *       every backend on each.
+ *
+ */
+
+int main(int argc, char* argv[])
+{
+   size_t n = 1 << 20;
+   uint64_t seed = 1;
+   for (int i = 1; i < argc; i++)
+   {
+      string arg = argv[i];
+      if (arg == "-n" && i + 1 < argc)
+         n = strtoull(argv[++i], NULL, 10);
+      else if (arg == "-s" && i + 1 < argc)
+         seed = strtoull(argv[++i], NULL, 10);
+      else
+      {
+         cerr << "usage: pqsuite [-n elements] [-s seed]" << endl;
+         return 2;
+      }
+   }
+   if (n == 0 || n >= (1u << ID_BITS))
+   {
+      cerr << "elements must be in 1 .. " << (1u << ID_BITS) - 1 << endl;
+      return 2;
+   }
+
+   cout << "workload,backend,elements,operations,ns_per_op,peak_kb" << endl;
+   mt19937_64 random(seed);
+   int failed = runAll(fillAndDrain("random", n, [&random](size_t)
+                                    { return random(); }));
+   failed |= runAll(dijkstra(n, seed));
+   failed |= runAll(timers(n, seed));
+   failed |= runAll(fillAndDrain("duplicates", n, [&random](size_t)
+                                 { return random() % 16; }));
+   failed |= runAll(fillAndDrain("ascending", n, [](size_t i)
+                                 { return (uint64_t)i; }));
+   failed |= runAll(fillAndDrain("descending", n, [n](size_t i)
+                                 { return (uint64_t)(n - i); }));
+   return failed;
+}
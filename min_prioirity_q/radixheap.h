@@ -0,0 +1,449 @@
+/**
+ *  @file: radixheap.h
+ *  @desc: RadixHeap, a monotone min priority queue for unsigned integer
+ *         keys (Ahuja, Mehlhorn, Orlin, Tarjan). It serves workloads whose
+ *         extracted keys never decrease, event simulations, timer queues,
+ *         Dijkstra, with the interface of MinPriorityQ.
+ *
+ *         Bucket b holds the keys whose highest bit that differs from the
+ *         last extracted minimum is bit b-1, bucket 0 the keys equal to it.
+ *         extractMin takes from bucket 0 and otherwise empties the first
+ *         filled bucket into lower ones, each key moves down at most once
+ *         per bit, so operations cost amortized O(log C) for keys up to C.
+ *         Buckets are plain vectors and are scanned front to back.
+ *
+ *         A key below the last extracted minimum cannot be ordered any
+ *         more, it is raised to that minimum, the way a timer set in the
+ *         past fires right away. Handles work as in MinPriorityQ.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____radixheap__
+#define ____radixheap__
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <stdint.h>
+
+using std::vector;
+
+template <typename Id, typename Key = uint64_t>
+class RadixHeap
+{
+public:
+   class Handle                 //Names one inserted element
+   {
+   public:
+      Handle();                 //Handle of no element
+   private:
+      friend class RadixHeap;
+      Handle(uint32_t,uint32_t);
+      uint32_t slot;            //Slot of the element
+      uint32_t generation;      //Generation of the slot at insert
+   };
+
+   RadixHeap();                 //Constructor
+
+   Handle insert(Id,Key);       //Adds an element, amortized O(1)
+   template <typename InputIt>  //Inserts a range of (id, key) pairs
+   void bulkInsert(InputIt first, InputIt last);
+   template <typename InputIt, typename OutputIt> //Same, writes the handles
+   void bulkInsert(InputIt first, InputIt last, OutputIt handles);
+   void decreaseKey(Handle,Key);//Lowers a key, a larger one is ignored
+   void increaseKey(Handle,Key);//Raises a key, a smaller one is ignored
+   void updateKey(Handle,Key);  //Sets a key, either direction
+   bool erase(Handle);          //Removes an element, false if it is gone
+   bool contains(Handle) const; //True while the element is queued
+   Id extractMin();             //Removes the minimum, amortized O(log C)
+   Key minKey();                //Key of the minimum, heap must not be empty
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements in the heap
+
+private:
+   class Entry                  //Element in a bucket
+   {
+   public:
+      Entry(Key,uint32_t);      //Constructor
+      Key key;
+      uint32_t slot;            //Slot of the id
+   };
+   class Slot                   //Id and bucket position of an element
+   {
+   public:
+      Slot(Id&&);               //Moves the id in
+      Id id;
+      uint32_t bucket;          //Bucket of the element, NONE when free
+      uint32_t index;           //Index in the bucket
+      uint32_t generation;      //Bumped every time the slot is freed
+   };
+
+   class NoHandles              //Output iterator dropping the handles
+   {
+   public:
+      NoHandles& operator*() { return *this; }
+      NoHandles& operator++() { return *this; }
+      NoHandles& operator=(const Handle&) { return *this; }
+   };
+
+   static const size_t BITS = 8 * sizeof(Key);
+   static const uint32_t NONE = 0xFFFFFFFFu;
+
+   uint32_t bucketOf(Key) const;//Bucket of a key relative to last
+   void place(Entry);           //Appends an entry to its bucket
+   Entry removeAt(uint32_t,uint32_t); //Takes an entry out of a bucket
+   void moveKey(uint32_t,Key);  //Gives the element of a slot a new key
+   void pull();                 //Refills bucket 0, heap must not be empty
+   uint32_t newSlot(Id&&);      //Slot for a new element
+   void releaseSlot(uint32_t);  //Frees the slot of a removed element
+
+   vector<Entry> buckets[BITS + 1];
+   vector<Slot> slots;          //Ids by slot
+   vector<uint32_t> freeSlots;  //Slots ready for reuse
+   Key last;                    //Last extracted minimum
+   size_t count;                //Number of elements
+};
+
+/**
+ * Desc: Constructors of Handle. The default one names no element.
+ *
+ */
+
+template <typename Id, typename Key>
+RadixHeap<Id,Key>::Handle::Handle()
+   : slot(NONE), generation(0)
+{
+
+}
+
+template <typename Id, typename Key>
+RadixHeap<Id,Key>::Handle::Handle(uint32_t new_slot, uint32_t new_generation)
+   : slot(new_slot), generation(new_generation)
+{
+
+}
+
+template <typename Id, typename Key>
+RadixHeap<Id,Key>::Entry::Entry(Key new_key, uint32_t new_slot)
+   : key(new_key), slot(new_slot)
+{
+
+}
+
+template <typename Id, typename Key>
+RadixHeap<Id,Key>::Slot::Slot(Id&& new_id)
+   : id(std::move(new_id)), bucket(NONE), index(0), generation(0)
+{
+
+}
+
+/**
+ * Desc: Constructor, the heap starts empty with 0 as the last minimum.
+ *
+ */
+
+template <typename Id, typename Key>
+RadixHeap<Id,Key>::RadixHeap()
+   : last(0), count(0)
+{
+
+}
+
+/**
+ * Desc: Adds an element to the bucket of its key.
+ *
+ * In:   Id - moved into the heap, Key - raised to the last minimum if below
+ * Out:  Handle - names the element
+ */
+
+template <typename Id, typename Key>
+typename RadixHeap<Id,Key>::Handle
+RadixHeap<Id,Key>::insert(Id id, Key key)
+{
+   uint32_t slot = newSlot(std::move(id));
+   place(Entry(key < last ? last : key, slot));
+   count++;
+   return Handle(slot, slots[slot].generation);
+}
+
+/**
+ * Desc: Inserts a range of (id, key) pairs. Buckets need no heap order, so
+ *       this is just a loop of inserts.
+ *
+ * In:   InputIt - range of std::pair<Id, Key> or alike
+ *       OutputIt - optional, gets the handle of every pair in range order
+ *
+ */
+
+template <typename Id, typename Key>
+template <typename InputIt>
+void RadixHeap<Id,Key>::bulkInsert(InputIt first, InputIt last)
+{
+   bulkInsert(first, last, NoHandles());
+}
+
+template <typename Id, typename Key>
+template <typename InputIt, typename OutputIt>
+void RadixHeap<Id,Key>::bulkInsert(InputIt first, InputIt last,
+                                   OutputIt handles)
+{
+   typedef decltype(*first) Entry;
+   for (; first != last; ++first)
+   {
+      Entry entry = *first;
+      *handles = insert(Id(std::forward<Entry>(entry).first), entry.second);
+      ++handles;
+   }
+}
+
+/**
+ * Desc: Lowers, raises or sets the key of an element. decreaseKey ignores
+ *       a larger key and increaseKey a smaller one. The element moves to
+ *       the bucket of its new key in O(1).
+ *
+ * In:   Handle - the element, ignored when gone
+ *       Key - The new key
+ *
+ */
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::decreaseKey(Handle handle, Key key)
+{
+   if (contains(handle))
+   {
+      const Slot& slot = slots[handle.slot];
+      if (key < buckets[slot.bucket][slot.index].key)
+         moveKey(handle.slot, key);
+   }
+}
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::increaseKey(Handle handle, Key key)
+{
+   if (contains(handle))
+   {
+      const Slot& slot = slots[handle.slot];
+      if (buckets[slot.bucket][slot.index].key < key)
+         moveKey(handle.slot, key);
+   }
+}
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::updateKey(Handle handle, Key key)
+{
+   if (contains(handle))
+      moveKey(handle.slot, key);
+}
+
+/**
+ * Desc: Removes the element named by a handle in O(1).
+ *
+ * In:   Handle - returned by insert
+ * Out:  boolean - false when the element was already gone
+ */
+
+template <typename Id, typename Key>
+bool RadixHeap<Id,Key>::erase(Handle handle)
+{
+   if (!contains(handle))
+      return false;
+   removeAt(slots[handle.slot].bucket, slots[handle.slot].index);
+   Id(std::move(slots[handle.slot].id));  //Frees what the id holds
+   releaseSlot(handle.slot);
+   count--;
+   return true;
+}
+
+/**
+ * Desc: True while the element named by a handle is in the heap.
+ *
+ */
+
+template <typename Id, typename Key>
+bool RadixHeap<Id,Key>::contains(Handle handle) const
+{
+   return handle.slot < slots.size()
+          && slots[handle.slot].generation == handle.generation
+          && slots[handle.slot].bucket != NONE;
+}
+
+/**
+ * Desc: Removes an element of the smallest key.
+ *
+ * In:   None - the heap must not be empty
+ * Out:  Id - id of the minimum
+ */
+
+template <typename Id, typename Key>
+Id RadixHeap<Id,Key>::extractMin()
+{
+   pull();
+   Entry entry = removeAt(0, (uint32_t)(buckets[0].size() - 1));
+   Id min = std::move(slots[entry.slot].id);
+   releaseSlot(entry.slot);
+   count--;
+   return min;
+}
+
+/**
+ * Desc: Key of the minimum. It may have to empty a bucket into lower ones
+ *       first, the work extractMin would do anyway.
+ *
+ */
+
+template <typename Id, typename Key>
+Key RadixHeap<Id,Key>::minKey()
+{
+   pull();
+   return last;
+}
+
+/**
+ * Desc: This function checks if the heap has no element left.
+ *
+ */
+
+template <typename Id, typename Key>
+bool RadixHeap<Id,Key>::empty() const
+{
+   return count == 0;
+}
+
+/**
+ * Desc: Number of elements in the heap.
+ *
+ */
+
+template <typename Id, typename Key>
+size_t RadixHeap<Id,Key>::size() const
+{
+   return count;
+}
+
+/**
+ * Desc: Bucket of a key: 0 when it equals the last minimum, otherwise one
+ *       plus the index of the highest bit in which the two differ.
+ *
+ */
+
+template <typename Id, typename Key>
+uint32_t RadixHeap<Id,Key>::bucketOf(Key key) const
+{
+   uint64_t differ = (uint64_t)(key ^ last);
+   return differ == 0 ? 0 : 64 - __builtin_clzll(differ);
+}
+
+/**
+ * Desc: Appends an entry to the bucket of its key and records where it is.
+ *
+ */
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::place(Entry entry)
+{
+   uint32_t b = bucketOf(entry.key);
+   slots[entry.slot].bucket = b;
+   slots[entry.slot].index = (uint32_t)buckets[b].size();
+   buckets[b].push_back(entry);
+}
+
+/**
+ * Desc: Takes an entry out of a bucket, the last entry fills its place.
+ *
+ * In:   uint32_t - bucket, uint32_t - index in the bucket
+ * Out:  Entry - the removed entry
+ */
+
+template <typename Id, typename Key>
+typename RadixHeap<Id,Key>::Entry
+RadixHeap<Id,Key>::removeAt(uint32_t b, uint32_t i)
+{
+   Entry entry = buckets[b][i];
+   buckets[b][i] = buckets[b].back();
+   slots[buckets[b][i].slot].index = i;
+   buckets[b].pop_back();
+   slots[entry.slot].bucket = NONE;
+   return entry;
+}
+
+/**
+ * Desc: Moves the element of a slot to the bucket of its new key.
+ *
+ */
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::moveKey(uint32_t slot, Key key)
+{
+   Entry entry = removeAt(slots[slot].bucket, slots[slot].index);
+   entry.key = key < last ? last : key;
+   place(entry);
+}
+
+/**
+ * Desc: Makes sure bucket 0 holds the minimum. When it is empty the first
+ *       filled bucket is scanned for its smallest key, which becomes the
+ *       last minimum, and all its entries are placed anew. Relative to
+ *       the new minimum they all land in lower buckets.
+ *
+ */
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::pull()
+{
+   if (!buckets[0].empty())
+      return;
+   size_t b = 1;
+   while (buckets[b].empty())
+      b++;
+   vector<Entry>& from = buckets[b];
+   Key min = from[0].key;
+   for (size_t i = 1; i < from.size(); i++)
+   {
+      if (from[i].key < min)
+         min = from[i].key;
+   }
+   last = min;
+   vector<Entry> moving;
+   moving.swap(from);
+   for (size_t i = 0; i < moving.size(); i++)
+      place(moving[i]);
+   moving.clear();
+   moving.swap(from);                  //Keeps the bucket's capacity
+}
+
+/**
+ * Desc: Slot for the id of a new element, a freed one when there is one.
+ *
+ */
+
+template <typename Id, typename Key>
+uint32_t RadixHeap<Id,Key>::newSlot(Id&& id)
+{
+   if (freeSlots.empty())
+   {
+      slots.push_back(Slot(std::move(id)));
+      return (uint32_t)(slots.size() - 1);
+   }
+   uint32_t slot = freeSlots.back();
+   freeSlots.pop_back();
+   slots[slot].id = std::move(id);
+   return slot;
+}
+
+/**
+ * Desc: Frees a slot whose element left the heap, handles of it go stale.
+ *
+ */
+
+template <typename Id, typename Key>
+void RadixHeap<Id,Key>::releaseSlot(uint32_t slot)
+{
+   slots[slot].bucket = NONE;
+   slots[slot].generation++;
+   freeSlots.push_back(slot);
+}
+
+#endif /* defined(____radixheap__) */
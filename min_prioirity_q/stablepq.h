@@ -0,0 +1,223 @@
+/**
+ *  @file: stablepq.h
+ *  @desc: StableMinPriorityQ, a MinPriorityQ with int keys in which equal
+ *         keys leave in the order they came in (FIFO). The key and an
+ *         insertion sequence number are packed into one 64 bit integer,
+ *         the key in the high half, so the heap still compares a single
+ *         integer and ties can no longer happen.
+ *
+ *         A key change counts as a new arrival and takes a fresh sequence
+ *         number. After 2^32 sequence numbers the queued elements are
+ *         renumbered in their current order, which keeps the order intact.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____stablepq__
+#define ____stablepq__
+
+#include "minpriority.h"
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstddef>
+#include <algorithm>
+#include <stdint.h>
+
+using std::vector;
+
+template <typename Id, size_t Arity = 2>
+class StableMinPriorityQ
+{
+   typedef MinPriorityQ<Id,uint64_t,std::less<uint64_t>,Arity> Queue;
+public:
+   typedef typename Queue::Handle Handle;
+
+   StableMinPriorityQ();        //Constructor
+
+   Handle insert(Id,int);       //Adds an element behind its equal keys
+   void decreaseKey(Handle,int);//Lowers a key, a larger one is ignored
+   void updateKey(Handle,int);  //Sets a key, either direction
+   bool erase(Handle);          //Removes an element, false if it is gone
+   bool contains(Handle) const; //True while the element is queued
+   Id extractMin();             //Oldest element of the smallest key
+   int minKey() const;          //Smallest key, queue must not be empty
+   bool empty() const;          //True when no element is left
+   size_t size() const;         //Number of elements in the queue
+
+private:
+   uint64_t pack(int);          //Key with the next sequence number
+   static int keyOf(uint64_t);  //Key of a packed key
+   void renumber();             //Restarts the sequence numbers
+
+   Queue queue;
+   uint64_t sequence;           //Next sequence number
+};
+
+/**
+ * Desc: Constructor, the queue starts empty.
+ *
+ */
+
+template <typename Id, size_t Arity>
+StableMinPriorityQ<Id,Arity>::StableMinPriorityQ()
+   : sequence(0)
+{
+
+}
+
+/**
+ * Desc: Adds an element, it leaves after every queued element of equal key.
+ *
+ * In:   Id - Id of the element, int - its key
+ * Out:  Handle - names the element
+ */
+
+template <typename Id, size_t Arity>
+typename StableMinPriorityQ<Id,Arity>::Handle
+StableMinPriorityQ<Id,Arity>::insert(Id id, int key)
+{
+   uint64_t packed = pack(key);
+   return queue.insert(std::move(id), packed);
+}
+
+/**
+ * Desc: Lowers the key of an element, which then queues behind the equal
+ *       keys already there. A larger or equal key is ignored.
+ *
+ */
+
+template <typename Id, size_t Arity>
+void StableMinPriorityQ<Id,Arity>::decreaseKey(Handle handle, int key)
+{
+   if (queue.contains(handle) && key < keyOf(queue.key(handle)))
+      queue.decreaseKey(handle, pack(key));
+}
+
+/**
+ * Desc: Sets the key of an element, it then queues behind the equal keys
+ *       already there.
+ *
+ */
+
+template <typename Id, size_t Arity>
+void StableMinPriorityQ<Id,Arity>::updateKey(Handle handle, int key)
+{
+   if (queue.contains(handle))
+      queue.updateKey(handle, pack(key));
+}
+
+/**
+ * Desc: Removes the element named by a handle.
+ *
+ */
+
+template <typename Id, size_t Arity>
+bool StableMinPriorityQ<Id,Arity>::erase(Handle handle)
+{
+   return queue.erase(handle);
+}
+
+/**
+ * Desc: True while the element named by a handle is in the queue.
+ *
+ */
+
+template <typename Id, size_t Arity>
+bool StableMinPriorityQ<Id,Arity>::contains(Handle handle) const
+{
+   return queue.contains(handle);
+}
+
+/**
+ * Desc: Extracts the element with the smallest key which came in first.
+ *
+ */
+
+template <typename Id, size_t Arity>
+Id StableMinPriorityQ<Id,Arity>::extractMin()
+{
+   return queue.extractMin();
+}
+
+/**
+ * Desc: Smallest key in the queue.
+ *
+ */
+
+template <typename Id, size_t Arity>
+int StableMinPriorityQ<Id,Arity>::minKey() const
+{
+   return keyOf(queue.minKey());
+}
+
+/**
+ * Desc: This function checks if the queue has no element left.
+ *
+ */
+
+template <typename Id, size_t Arity>
+bool StableMinPriorityQ<Id,Arity>::empty() const
+{
+   return queue.empty();
+}
+
+/**
+ * Desc: Number of elements in the queue.
+ *
+ */
+
+template <typename Id, size_t Arity>
+size_t StableMinPriorityQ<Id,Arity>::size() const
+{
+   return queue.size();
+}
+
+/**
+ * Desc: Packs a key and the next sequence number. Flipping the sign bit
+ *       maps int order onto unsigned order.
+ *
+ */
+
+template <typename Id, size_t Arity>
+uint64_t StableMinPriorityQ<Id,Arity>::pack(int key)
+{
+   if (sequence > 0xFFFFFFFFu)
+      renumber();
+   uint64_t high = (uint32_t)key ^ 0x80000000u;
+   return high << 32 | sequence++;
+}
+
+template <typename Id, size_t Arity>
+int StableMinPriorityQ<Id,Arity>::keyOf(uint64_t packed)
+{
+   return (int)((uint32_t)(packed >> 32) ^ 0x80000000u);
+}
+
+/**
+ * Desc: Gives the queued elements the sequence numbers 0 .. n-1 in their
+ *       current order. The packed keys are collected and sorted, then each
+ *       one's low half becomes its rank. Packed keys are distinct and the
+ *       ranks keep their order, so the heap and the handles stay valid.
+ *
+ */
+
+template <typename Id, size_t Arity>
+void StableMinPriorityQ<Id,Arity>::renumber()
+{
+   vector<uint64_t> packed;
+   packed.reserve(queue.size());
+   queue.rekey([&packed](uint64_t key) { packed.push_back(key); return key; });
+   std::sort(packed.begin(), packed.end());
+   queue.rekey([&packed](uint64_t key)
+   {
+      uint64_t rank = std::lower_bound(packed.begin(), packed.end(), key)
+                      - packed.begin();
+      return (key >> 32 << 32) | rank;
+   });
+   sequence = packed.size();
+}
+
+#endif /* defined(____stablepq__) */
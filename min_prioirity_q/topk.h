@@ -0,0 +1,121 @@
+/**
+ *  @file: topk.h
+ *  @desc: TopK keeps the k smallest elements of a stream, or the k largest
+ *         with std::greater, in a heap of k elements whose root is the
+ *         worst of them. A new element which is not better than the root
+ *         is turned away after that one comparison, a better one replaces
+ *         the root with a single O(log k) sift. Memory stays at k elements
+ *         however long the stream is.
+ *
+ *  @author: Diney Wankhede
+ *  @date: 4/22/15
+ *
+ */
+
+#ifndef ____topk__
+#define ____topk__
+
+#include "minpriority.h"
+#include <vector>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+using std::vector;
+using std::pair;
+
+template <typename Id, typename Key = int, typename Compare = std::less<Key> >
+class TopK
+{
+public:
+   explicit TopK(size_t k);     //Keeps the best k elements
+   bool offer(Id,Key);          //Takes an element, false when turned away
+   vector<pair<Id,Key> > extractSorted(); //Best first, empties the heap
+   size_t size() const;         //Number of elements kept, at most k
+
+private:
+   class Worse                  //Reverses Compare, the worst is the minimum
+   {
+   public:
+      bool operator()(const Key& a, const Key& b) const
+      {
+         return compare(b, a);
+      }
+      Compare compare;
+   };
+
+   MinPriorityQ<Id,Key,Worse> kept; //The best elements, worst at the root
+   size_t limit;                //k
+   Compare compare;             //Order of the keys, best first
+};
+
+/**
+ * Desc: Constructor.
+ *
+ * In:   size_t - k, the number of elements to keep
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+TopK<Id,Key,Compare>::TopK(size_t k)
+   : limit(k)
+{
+
+}
+
+/**
+ * Desc: Keeps an element while fewer than k are kept, otherwise replaces
+ *       the worst kept element when the new one is better.
+ *
+ * In:   Id - Id of the element, Key - its key
+ * Out:  boolean - true when the element was kept
+ */
+
+template <typename Id, typename Key, typename Compare>
+bool TopK<Id,Key,Compare>::offer(Id id, Key key)
+{
+   if (kept.size() < limit)
+   {
+      kept.insert(std::move(id), key);
+      return true;
+   }
+   if (limit == 0 || !compare(key, kept.minKey()))
+      return false;
+   kept.replaceMin(std::move(id), key);
+   return true;
+}
+
+/**
+ * Desc: The kept elements from best to worst. They come out of the heap
+ *       worst first and are reversed.
+ *
+ * Out:  vector - (id, key) pairs, the heap is left empty
+ */
+
+template <typename Id, typename Key, typename Compare>
+vector<pair<Id,Key> > TopK<Id,Key,Compare>::extractSorted()
+{
+   vector<pair<Id,Key> > sorted;
+   sorted.reserve(kept.size());
+   while (!kept.empty())
+   {
+      Key key = kept.minKey();
+      sorted.push_back(pair<Id,Key>(kept.extractMin(), key));
+   }
+   std::reverse(sorted.begin(), sorted.end());
+   return sorted;
+}
+
+/**
+ * Desc: Number of elements kept.
+ *
+ */
+
+template <typename Id, typename Key, typename Compare>
+size_t TopK<Id,Key,Compare>::size() const
+{
+   return kept.size();
+}
+
+#endif /* defined(____topk__) */